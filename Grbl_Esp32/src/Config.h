@@ -452,6 +452,14 @@ const double ARC_ANGULAR_TRAVEL_EPSILON = 5E-7;  // Float (radians)
 // time step. Also, keep in mind that the Arduino delay timer is not very accurate for long delays.
 const int DWELL_TIME_STEP = 50;  // Integer (1-255) (milliseconds)
 
+// How often a spindle that can measure its speed is checked while motion waits for it to
+// reach speed. The VFDs measure the speed by polling, so this does not have to be much shorter
+// than a Modbus transaction.
+const int SPINDLE_AT_SPEED_POLL = 10;  // Integer (milliseconds)
+
+// Time between the steps of a PWM spindle ramp; see $Spindle/Ramp/Up and $Spindle/Ramp/Down
+const int SPINDLE_RAMP_TICK = 5;  // Integer (milliseconds)
+
 // For test use only. This uses the ESP32's RMT peripheral to generate step pulses
 // It allows the use of the STEP_PULSE_DELAY (see below) and it automatically ends the
 // pulse in one operation.
@@ -484,6 +492,11 @@ const int DWELL_TIME_STEP = 50;  // Integer (1-255) (milliseconds)
 // support up to 256 characters.
 // #define LINE_BUFFER_SIZE 80  // Uncomment to override default in protocol.h
 
+// Most pixels in one $Raster line. Each planner block and each stepper block keeps room for
+// this many, so it costs (BLOCK_BUFFER_SIZE + SEGMENT_BUFFER_SIZE) bytes per pixel. A line
+// of the default LINE_BUFFER_SIZE holds fewer pixels than this in base64.
+const int RASTER_MAX_PIXELS = 192;
+
 // Serial send and receive buffer size. The receive buffer is often used as another streaming
 // buffer to store incoming blocks to be processed by Grbl when its ready. Most streaming
 // interfaces will character count and track each block send to each block response. So,
@@ -494,9 +507,23 @@ const int DWELL_TIME_STEP = 50;  // Integer (1-255) (milliseconds)
 // 115200 baud will take 5 msec to transmit a typical 55 character report. Worst case reports are
 // around 90-100 characters. As long as the serial TX buffer doesn't get continually maxed, Grbl
 // will continue operating efficiently. Size the TX buffer around the size of a worst-case report.
-// #define RX_BUFFER_SIZE 128 // (1-254) Uncomment to override defaults in serial.h
+// The RX buffer size is also the free space reported to senders in the 'Bf:' status field.
+// #define RX_BUFFER_SIZE 1024 // (256-16384) Uncomment to override defaults in serial.h
 // #define TX_BUFFER_SIZE 100 // (1-254)
 
+// Flow control for the serial port, so a sender can stream far ahead of the 'ok' responses
+// without overrunning the RX buffer. With RTS/CTS, SERIAL_RTS_PIN and SERIAL_CTS_PIN must be
+// defined in the machine file; the UART drops RTS once the RX buffer is full. With XON/XOFF,
+// XOFF is sent when the RX buffer is 3/4 full and XON once it has drained below 1/4.
+// #define SERIAL_FLOW_CONTROL_RTS_CTS   // Default disabled. Uncomment to enable.
+// #define SERIAL_FLOW_CONTROL_XON_XOFF  // Default disabled. Uncomment to enable.
+
+// While an SD job runs from the top, the byte offset and parser modal state of every Nth line are
+// written to a sidecar index "<file>.idx" next to the job file. '$SD/Run=file,line' uses the index
+// to seek close to the requested line and restore the modal state, instead of re-parsing the whole
+// file. Smaller values make resume faster at the cost of a larger index. 0 disables the index.
+const int SD_LINE_INDEX_INTERVAL = 100;  // Integer (0-65535) lines
+
 // A simple software debouncing feature for hard limit switches. When enabled, the limit
 // switch interrupt unblock a waiting task which will recheck the limit switch pins after
 // a short delay. Default disabled
@@ -541,14 +568,16 @@ const int DEBOUNCE_PERIOD = 32;   // in milliseconds default 32 milliseconds
 
 // Writing to non-volatile storage (NVS) can take a long time and interfere with timely instruction
 // execution, causing problems for the stepper ISRs and serial comm ISRs and subsequent loss of
-// stepper position and serial data. This configuration option forces the planner buffer to completely
-// empty whenever the NVS is written, to prevent any chance of lost steps.
-// It doesn't prevent loss of serial Rx data, especially if a GUI is premptively filling up the
-// serial Rx buffer.  GUIs should detect GCodes that write to NVS - notably G10,G28.1,G30.1 -
-// and wait for an 'ok' before sending more data.
+// stepper position and serial data. Setting changes are collected in a write-back cache (NvsCache.h)
+// and written out later. This configuration option holds those writes back until motion has
+// stopped, to prevent any chance of lost steps. During a job they are written at the next planner
+// buffer sync (M0, M6, G4, etc.) that comes after NVS_CACHE_IDLE_MS, or once NVS_CACHE_DEADLINE_MS
+// has passed even while moving. If the cache fills up, the planner buffer is synced and then it is
+// written out, as every such write used to do.
 // NOTE: Most setting changes - $ commands - are blocked when a job is running. Coordinate setting
 // GCode commands (G10,G28/30.1) are not blocked, since they are part of an active streaming job.
-// This option forces a planner buffer sync only with such GCode commands.
+// The coordinate offsets and the active tool skip the cache so a power loss cannot lose them, and
+// they force a planner buffer sync before they are written.
 #define FORCE_BUFFER_SYNC_DURING_NVS_WRITE  // Default enabled. Comment to disable.
 
 // In Grbl v0.9 and prior, there is an old outstanding bug where the `WPos:` work position reported
@@ -603,22 +632,9 @@ const double PARKING_PULLOUT_INCREMENT = 5.0;    // Spindle pull-out and plunge
 
 #define DISABLE_SPINDLE_DURING_HOLD  // Default enabled. Comment to disable.
 
-// Enables a piecewise linear model of the spindle PWM/speed output. Requires a solution by the
-// 'fit_nonlinear_spindle.py' script in the /doc/script folder of the repo. See file comments
-// on how to gather spindle data and run the script to generate a solution.
-// #define ENABLE_PIECEWISE_LINEAR_SPINDLE  // Default disabled. Uncomment to enable.
-
-// N_PIECES, RPM_MAX, RPM_MIN, RPM_POINTxx, and RPM_LINE_XX constants are all set and given by
-// the 'fit_nonlinear_spindle.py' script solution. Used only when ENABLE_PIECEWISE_LINEAR_SPINDLE
-// is enabled. Make sure the constant values are exactly the same as the script solution.
-// NOTE: When N_PIECES < 4, unused RPM_LINE and RPM_POINT defines are not required and omitted.
-/*
-#define N_PIECES 4  // Integer (1-4). Number of piecewise lines used in script solution.
-#define RPM_MAX  11686.4  // Max RPM of model. $30 > RPM_MAX will be limited to RPM_MAX.
-#define RPM_MIN  202.5    // Min RPM of model. $31 < RPM_MIN will be limited to RPM_MIN.
-*/
-
-const int N_PIECES = 3;
-
-const double RPM_MAX = 23935.2;
-const double RPM_MIN = 2412.2;
+// A PWM spindle with a nonlinear speed curve, like many VFD 0-10V inputs, can be calibrated
+// with $Spindle/PWM/Map, a list of measured rpm:percent points. The 'fit_nonlinear_spindle.py'
+// script in the /doc/script folder of the repo fits the points to measured data. The curve is
+// expanded into a table when the spindle starts, so the stepper ISR only reads the table.
+const int SPINDLE_PWM_MAP_POINTS = 16;   // Integer. Most points $Spindle/PWM/Map can have
+const int SPINDLE_PWM_LUT_SIZE   = 256;  // Integer. Table buckets from min to max rpm
@@ -82,6 +82,14 @@
 #    define DEFAULT_VERBOSE_ERRORS 0
 #endif
 
+#ifndef DEFAULT_STREAM_ACK_LINES
+#    define DEFAULT_STREAM_ACK_LINES 16  // lines per ack in streaming mode
+#endif
+
+#ifndef DEFAULT_STREAM_ACK_MS
+#    define DEFAULT_STREAM_ACK_MS 50  // longest ack delay in streaming mode
+#endif
+
 #ifndef DEFAULT_JUNCTION_DEVIATION
 #    define DEFAULT_JUNCTION_DEVIATION 0.01  // $11 mm
 #endif
@@ -171,6 +179,10 @@
 #    define DEFAULT_LASER_FULL_POWER 1000
 #endif
 
+#ifndef DEFAULT_LASER_POWER_UPDATES
+#    define DEFAULT_LASER_POWER_UPDATES 1  // laser power changes per step segment in M4; 1 for once per segment
+#endif
+
 #ifndef DEFAULT_SPINDLE_RPM_MAX             // $30
 #    define DEFAULT_SPINDLE_RPM_MAX 1000.0  // rpm
 #endif
@@ -191,6 +203,10 @@
 #    define DEFAULT_SPINDLE_MAX_VALUE 100.0  // $36 Percent of full period (extended set)
 #endif
 
+#ifndef DEFAULT_SPINDLE_PWM_MAP
+#    define DEFAULT_SPINDLE_PWM_MAP ""  // rpm:percent pairs, like "2400:10,12000:55,24000:100"; empty for $34-$36
+#endif
+
 #ifndef DEFAULT_SPINDLE_DELAY_SPINUP
 #    define DEFAULT_SPINDLE_DELAY_SPINUP 0
 #endif
@@ -203,6 +219,26 @@
 #    define DEFAULT_SPINDLE_DELAY_SPINDOWN 0
 #endif
 
+#ifndef DEFAULT_SPINDLE_RAMP_UP
+#    define DEFAULT_SPINDLE_RAMP_UP 0  // seconds from min to max rpm; 0 for no ramp
+#endif
+
+#ifndef DEFAULT_SPINDLE_RAMP_DOWN
+#    define DEFAULT_SPINDLE_RAMP_DOWN 0
+#endif
+
+#ifndef DEFAULT_SPINDLE_AT_SPEED_TOLERANCE
+#    define DEFAULT_SPINDLE_AT_SPEED_TOLERANCE 2.5  // percent of the requested speed, at least 100 rpm
+#endif
+
+#ifndef DEFAULT_SPINDLE_AT_SPEED_TIMEOUT
+#    define DEFAULT_SPINDLE_AT_SPEED_TIMEOUT 10.0  // seconds without getting closer to the requested speed
+#endif
+
+#ifndef SPINDLE_TACH_PPR
+#    define SPINDLE_TACH_PPR 1  // pulses per revolution on SPINDLE_TACH_PIN
+#endif
+
 #ifndef DEFAULT_INVERT_SPINDLE_DIRECTION_PIN
 #    define DEFAULT_INVERT_SPINDLE_DIRECTION_PIN 0
 #endif
@@ -505,6 +541,10 @@
 #    define SDCARD_DET_PIN UNDEFINED_PIN
 #endif
 
+#ifndef SPINDLE_TACH_PIN
+#    define SPINDLE_TACH_PIN UNDEFINED_PIN
+#endif
+
 #ifndef STEPPERS_DISABLE_PIN
 #    define STEPPERS_DISABLE_PIN UNDEFINED_PIN
 #endif
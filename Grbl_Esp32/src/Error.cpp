@@ -88,4 +88,6 @@ std::map<Error, const char*> ErrorNames = {
     { Error::AsdaMode, "Incompatible servo mode" },
     { Error::AsdaAlarm, "Servo ALARM" },
     { Error::InvalidWorkPlane, "Work Plane miss match" },
+    { Error::RasterInvalid, "Invalid raster line" },
+    { Error::RasterNotLaser, "Raster needs laser mode" },
 };
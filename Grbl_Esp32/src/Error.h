@@ -92,6 +92,8 @@ enum class Error : uint8_t {
     AsdaMode                    = 150,  // Current servo mode is not compatible with the G Code input
     AsdaAlarm                   = 151,  // Serve fell in to alarm mode
     InvalidWorkPlane            = 160,  // Work Plane miss match
+    RasterInvalid               = 170,  // $Raster line could not be decoded
+    RasterNotLaser              = 171,  // $Raster needs laser mode
 };
 
 extern std::map<Error, const char*> ErrorNames;
@@ -64,6 +64,20 @@ void gc_sync_position() {
     system_convert_array_steps_to_mpos(gc_state.position, sys_position);
 }
 
+// Work X zero in machine coordinates. With G96 this is the spindle axis.
+static float spindle_axis_x() {
+    return gc_state.coord_system[X_AXIS] + gc_state.coord_offset[X_AXIS] + gc_state.tool_length_offset[X_AXIS];
+}
+
+// The spindle RPM that gives the G96 surface speed at the current X radius, up to the G96 D value
+static float surface_speed_rpm() {
+    if (gc_state.surface_speed == 0) {
+        return 0;
+    }
+    float rpm = gc_state.surface_speed / (2 * M_PI * fabsf(gc_state.position[X_AXIS] - spindle_axis_x()));
+    return rpm < gc_state.max_spindle_speed ? rpm : gc_state.max_spindle_speed;
+}
+
 // Edit GCode line in-place, removing whitespace and comments and
 // converting to uppercase
 void collapseGCode(char* line) {
@@ -385,6 +399,18 @@ Error gc_execute_line(char* line, uint8_t client) {
                         gc_block.modal.feed_rate = FeedRate::UnitsPerMin;
                         mg_word_bit              = ModalGroup::MG5;
                         break;
+                    case 95:
+                        gc_block.modal.feed_rate = FeedRate::UnitsPerRev;
+                        mg_word_bit              = ModalGroup::MG5;
+                        break;
+                    case 96:
+                        gc_block.modal.spindle_speed_mode = SpindleSpeedMode::SurfaceSpeed;
+                        mg_word_bit                       = ModalGroup::MG14;
+                        break;
+                    case 97:
+                        gc_block.modal.spindle_speed_mode = SpindleSpeedMode::Rpm;
+                        mg_word_bit                       = ModalGroup::MG14;
+                        break;
                     case 20:
                         gc_block.modal.units = Units::Inches;
                         mg_word_bit          = ModalGroup::MG6;
@@ -946,15 +972,19 @@ Error gc_execute_line(char* line, uint8_t client) {
         if (bit_istrue(command_words, ~(bit(ModalGroup::MM10)))) {
             FAIL(Error::GcodeModalGroupViolation)
         };
+        // Don't switch modes or touch the hardware while checking a program
+        if (sys.state == State::CheckMode) {
+            return Error::Ok;
+        }
         switch (gc_block.modal.RowndAction) {
             case SpecialActions::ModeSwitchLathe:
-                return spindle_type->setEnumValue((int8_t)SpindleType::ASDA_CN1);
+                return Spindles::Spindle::switch_to(SpindleType::ASDA_CN1);
                 break;
             case SpecialActions::ModeSwitch4thAxis:
-                return spindle_type->setEnumValue((int8_t)SpindleType::PWM);
+                return Spindles::Spindle::switch_to(SpindleType::PWM);
                 break;
             case SpecialActions::ModeSwitchLaser:
-                return spindle_type->setEnumValue((int8_t)SpindleType::LASER);
+                return Spindles::Spindle::switch_to(SpindleType::LASER);
                 break;
             case SpecialActions::DisconnectATC:
                 return setATCConnection(false);
@@ -1007,6 +1037,18 @@ Error gc_execute_line(char* line, uint8_t client) {
             // value in the block. If no F word is passed with a motion command that requires a feed rate, this will error
             // out in the motion modes error-checking. However, if no F word is passed with NO motion command that requires
             // a feed rate, we simply move on and the state feed rate value gets updated to zero and remains undefined.
+        } else if (gc_block.modal.feed_rate == FeedRate::UnitsPerRev) {  // = G95
+            // F is the distance per spindle revolution. The planner turns it into a rate with the spindle speed.
+            if (gc_block.modal.motion == Motion::G33 || gc_block.modal.motion == Motion::G76) {
+                FAIL(Error::GcodeAxisCommandConflict);
+            }
+            if (bit_istrue(value_words, bit(GCodeWord::F))) {
+                if (gc_block.modal.units == Units::Inches) {
+                    gc_block.values.f *= MM_PER_INCH;
+                }
+            } else if (gc_state.modal.feed_rate == FeedRate::UnitsPerRev) {
+                gc_block.values.f = gc_state.feed_rate;  // Push last state feed rate
+            }  // Else, switching to G95, so the last feed rate is in other units. An F word is needed.
         } else {  // = G94
             if (gc_block.modal.motion == Motion::G33 || gc_block.modal.motion == Motion::G76) {
                 if (gc_block.modal.motion == Motion::G33) {
@@ -1206,7 +1248,34 @@ Error gc_execute_line(char* line, uint8_t client) {
     }
     // bit_false(value_words,bit(GCodeWord::F)); // NOTE: Single-meaning value word. Set at end of error-checking.
     // [4. Set spindle speed ]: S is negative (done.)
-    if (bit_isfalse(value_words, bit(GCodeWord::S))) {
+    if (gc_block.modal.spindle_speed_mode == SpindleSpeedMode::SurfaceSpeed) {
+        // G96 S is the surface speed in m/min or ft/min, converted here to mm/min. D limits the RPM.
+        if (bit_istrue(value_words, bit(GCodeWord::S))) {
+            gc_block.values.s *= (gc_block.modal.units == Units::Inches) ? MM_PER_INCH * 12 : 1000;
+        } else if (gc_state.modal.spindle_speed_mode == SpindleSpeedMode::SurfaceSpeed) {
+            gc_block.values.s = gc_state.surface_speed;
+        } else {
+            FAIL(Error::GcodeValueWordMissing);  // [G96 without S]
+        }
+        if (bit_istrue(value_words, bit(GCodeWord::D))) {
+            if (gc_block.values.d <= 0) {
+                FAIL(Error::NegativeValue);  // [G96 D must be more than zero]
+            }
+            bit_false(value_words, bit(GCodeWord::D));
+        } else if (gc_state.modal.spindle_speed_mode == SpindleSpeedMode::SurfaceSpeed) {
+            gc_block.values.d = gc_state.max_spindle_speed;
+        } else {
+            gc_block.values.d = spindle->max_rpm();
+        }
+        // The spindle holds its speed to its own range, e.g. $29 for the lathe chuck, so the RPM
+        // the parser and the stepper compute must not go past it either
+        if (gc_block.values.d > spindle->max_rpm()) {
+            gc_block.values.d = spindle->max_rpm();
+        }
+        if (axis_command == AxisCommand::MotionMode && (gc_block.modal.motion == Motion::G33 || gc_block.modal.motion == Motion::G76)) {
+            FAIL(Error::GcodeUnsupportedCommand);  // [Threads need a fixed spindle speed]
+        }
+    } else if (bit_isfalse(value_words, bit(GCodeWord::S))) {
         gc_block.values.s = gc_state.spindle_speed;
     }
     bit_false(value_words, bit(GCodeWord::S));  // NOTE: Single-meaning value word. Set at end of error-checking.
@@ -1574,6 +1643,9 @@ Error gc_execute_line(char* line, uint8_t client) {
             if (gc_block.values.f == 0.0 && !gc_state.Rownd_special) {
                 FAIL(Error::GcodeUndefinedFeedRate);  // [Feed rate undefined]
             }
+            if (gc_block.modal.feed_rate == FeedRate::UnitsPerRev && (gc_block.modal.spindle == SpindleState::Disable || gc_block.values.s == 0.0)) {
+                FAIL(Error::GcodeUndefinedFeedRate);  // [G95 without a turning spindle]
+            }
             switch (gc_block.modal.motion) {
                 case Motion::None:
                     break;  // Feed rate is unnecessary
@@ -1750,12 +1822,17 @@ Error gc_execute_line(char* line, uint8_t client) {
                     }
                     break;
                 case Motion::G33:
+                case Motion::G76:
+                    // The threading cycles reconfigure the spindle and run their own lines, so skip them in check mode
+                    if (sys.state == State::CheckMode) {
+                        return Error::Ok;
+                    }
+                    if (gc_block.modal.motion == Motion::G76) {
+                        return rownd_G76(&gc_block, &g76_params, &gc_state);
+                    }
                     return rownd_G33(&gc_block, gc_state.position);  // This code works, but not as well as we hoped, so we're disabling it for now. We might revisit and improve it in the distant future, but for now, it's on hold.
                     FAIL(Error::GcodeUnsupportedCommand);
                     break;
-                case Motion::G76:
-                    return rownd_G76(&gc_block, &g76_params, &gc_state);
-                    break;
                 default:
                     FAIL(Error::GcodeUnsupportedCommand);
                     break;
@@ -1851,12 +1928,22 @@ Error gc_execute_line(char* line, uint8_t client) {
     gc_state.modal.feed_rate = gc_block.modal.feed_rate;
     if (gc_state.modal.feed_rate == FeedRate::InverseTime) {
         pl_data->motion.inverseTime = 1;  // Set condition flag for planner use.
+    } else if (gc_state.modal.feed_rate == FeedRate::UnitsPerRev) {
+        pl_data->motion.feedPerRev = 1;
     }
     // [3. Set feed rate ]:
     gc_state.feed_rate = gc_block.values.f;   // Always copy this value. See feed rate error-checking.
     pl_data->feed_rate = gc_state.feed_rate;  // Record data for planner use.
 
     // [4. Set spindle speed ]:
+    // With G96, the S value becomes the RPM at the current position. The RPM at the end of each
+    // move is kept in gc_state.spindle_speed, so this only syncs when the surface speed changes.
+    gc_state.modal.spindle_speed_mode = gc_block.modal.spindle_speed_mode;
+    if (gc_state.modal.spindle_speed_mode == SpindleSpeedMode::SurfaceSpeed) {
+        gc_state.surface_speed     = gc_block.values.s;
+        gc_state.max_spindle_speed = gc_block.values.d;
+        gc_block.values.s          = surface_speed_rpm();
+    }
     if ((gc_state.spindle_speed != gc_block.values.s) || bit_istrue(gc_parser_flags, GCParserFlags::GCParserLaserForceSync)) {
         if (gc_state.modal.spindle != SpindleState::Disable) {
             if (bit_isfalse(gc_parser_flags, GCParserFlags::GCParserLaserIsMotion)) {
@@ -1879,6 +1966,9 @@ Error gc_execute_line(char* line, uint8_t client) {
         if (gc_block.values.t <= 0) {
             FAIL(Error::InvalidValue);
         }
+        if (sys.state == State::CheckMode) {
+            return Error::Ok;  // No ATC moves or tool setting writes in check mode
+        }
         tool_selected->setValue(gc_block.values.t);
         if (tool_selected->get() > tool_count->get()) {
             FAIL(Error::GcodeMaxValueExceeded);
@@ -2059,6 +2149,11 @@ Error gc_execute_line(char* line, uint8_t client) {
     // NOTE: Commands G10,G28,G30,G92 lock out and prevent axis words from use in motion modes.
     // Enter motion modes only if there are axis words or a motion mode command word in the block.
     gc_state.modal.motion = gc_block.modal.motion;
+    if (gc_state.modal.spindle_speed_mode == SpindleSpeedMode::SurfaceSpeed) {
+        pl_data->surface_speed     = gc_state.surface_speed;
+        pl_data->max_spindle_speed = gc_state.max_spindle_speed;
+        pl_data->spindle_axis_x    = spindle_axis_x();
+    }
     if (gc_state.modal.motion != Motion::None) {
         if (axis_command == AxisCommand::MotionMode) {
             GCUpdatePos gc_update_pos = GCUpdatePos::Target;
@@ -2089,6 +2184,9 @@ Error gc_execute_line(char* line, uint8_t client) {
             }  // == GCUpdatePos::None
         }
     }
+    if (gc_state.modal.spindle_speed_mode == SpindleSpeedMode::SurfaceSpeed) {
+        gc_state.spindle_speed = surface_speed_rpm();  // The planner has already changed it along the way
+    }
     // [21. Program flow ]:
     // M0,M1,M2,M30: Perform non-running program flow actions. During a program pause, the buffer may
     // refill and can only be resumed by the cycle start run-time command.
@@ -2115,6 +2213,9 @@ Error gc_execute_line(char* line, uint8_t client) {
             // LinuxCNC's program end descriptions and testing. Only modal groups [G-code 1,2,3,5,7,12]
             // and [M-code 7,8,9] reset to [G1,G17,G90,G94,G40,G54,M5,M9,M48]. The remaining modal groups
             // [G-code 4,6,8,10,13,14,15] and [M-code 4,5,6] and the modal words [F,S,T,H] do not reset.
+            if (gc_state.modal.feed_rate == FeedRate::UnitsPerRev) {
+                gc_state.feed_rate = 0;  // A feed per revolution is no feed rate for G94
+            }
             gc_state.modal.motion       = Motion::Linear;
             gc_state.modal.plane_select = DEFAULT_PLANE;
             gc_state.modal.distance     = Distance::Absolute;
@@ -37,7 +37,7 @@ enum class ModalGroup : uint8_t {
     MG2  = 2,   // [G17,G18,G19] Plane selection
     MG3  = 3,   // [G90,G91] Distance mode
     MG4  = 4,   // [G91.1] Arc IJK distance mode
-    MG5  = 5,   // [G93,G94] Feed rate mode
+    MG5  = 5,   // [G93,G94,G95] Feed rate mode
     MG6  = 6,   // [G20,G21] Units
     MG7  = 7,   // [G40] Cutter radius compensation mode. G41/42 NOT SUPPORTED.
     MG8  = 8,   // [G43,G43.1,G49] Tool length offset
@@ -50,6 +50,7 @@ enum class ModalGroup : uint8_t {
     MM8  = 15,  // [M7,M8,M9] Coolant control
     MM9  = 16,  // [M56] Override control
     MM10 = 17,  // [M100 - M199] User Defined http://linuxcnc.org/docs/html/gcode/overview.html#_modal_groups
+    MG14 = 18,  // [G96,G97] Spindle speed mode
 };
 
 // Command actions for within execution-type modal groups (motion, stopping, non-modal). Used
@@ -123,6 +124,7 @@ enum class ProgramFlow : uint8_t {
 enum class FeedRate : uint8_t {
     UnitsPerMin = 0,  // G94 (Default: Must be zero)
     InverseTime = 1,  // G93 (Do not alter value)
+    UnitsPerRev = 2,  // G95
 };
 
 // Modal Group MG6: Units mode
@@ -137,6 +139,12 @@ enum class CutterCompensation : uint8_t {
     Enable  = 1,
 };
 
+// Modal Group MG14: Spindle speed mode
+enum class SpindleSpeedMode : uint8_t {
+    Rpm          = 0,  // G97 (Default: Must be zero)
+    SurfaceSpeed = 1,  // G96
+};
+
 // Modal Group MG13: Control mode
 enum class ControlMode : uint8_t {
     ExactPath = 0,  // G61 (Default: Must be zero)
@@ -292,14 +300,15 @@ enum G76_taperModes : uint8_t {
 // NOTE: When this struct is zeroed, the 0 values in the above types set the system defaults.
 typedef struct {
     Motion   motion;     // {G0,G1,G2,G3,G38.2,G80}
-    FeedRate feed_rate;  // {G93,G94}
+    FeedRate feed_rate;  // {G93,G94,G95}
     Units    units;      // {G20,G21}
     Distance distance;   // {G90,G91}
     // ArcDistance distance_arc; // {G91.1} NOTE: Don't track. Only default supported.
     Plane plane_select;  // {G17,G18,G19}
     // CutterCompensation cutter_comp;  // CutterCompensation {G40} removed NOTE: Don't track. Only default supported.
-    ToolLengthOffset tool_length;   // {G43.1,G49}
-    CoordIndex       coord_select;  // {G54,G55,G56,G57,G58,G59}
+    ToolLengthOffset tool_length;         // {G43.1,G49}
+    CoordIndex       coord_select;        // {G54,G55,G56,G57,G58,G59}
+    SpindleSpeedMode spindle_speed_mode;  // {G96,G97}
     // uint8_t control;      // {G61} NOTE: Don't track. Only default supported.
     ProgramFlow    program_flow;  // {M0,M1,M2,M30}
     CoolantState   coolant;       // {M7,M8,M9}
@@ -312,7 +321,7 @@ typedef struct {
 
 typedef struct {
     float   e;                // M67
-    uint8_t d;                // G76
+    float   d;                // G76, G96 max spindle speed
     float   f;                // Feed
     uint8_t h;                // G43
     float   ijk[3];           // I,J,K Axis arc offsets - only 3 are possible
@@ -332,9 +341,11 @@ typedef struct {
 
     bool Rownd_special = false;
 
-    float   spindle_speed;  // RPM
-    float   feed_rate;      // Millimeters/min
-    int32_t line_number;    // Last line number sent
+    float   spindle_speed;      // RPM
+    float   surface_speed;      // G96 S in millimeters/min
+    float   max_spindle_speed;  // G96 D in RPM
+    float   feed_rate;          // Millimeters/min
+    int32_t line_number;        // Last line number sent
 
     float position[MAX_N_AXIS];  // Where the interpreter considers the tool to be at this point in the code
 
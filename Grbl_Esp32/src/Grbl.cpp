@@ -322,7 +322,7 @@ Error rownd_G76(parser_block_t* gc_block, g76_params_t* g76_params, parser_state
 
     if (is_lathe) {
         gc_state->Rownd_special = true;
-        spindle_type->setEnumValue((int8_t)SpindleType::PWM);
+        Spindles::Spindle::switch_to(SpindleType::PWM);
         gc_state->Rownd_special = false;
     } else {
         return Error::AsdaMode;
@@ -668,7 +668,7 @@ Error rownd_G76(parser_block_t* gc_block, g76_params_t* g76_params, parser_state
 
     if (is_lathe) {
         gc_state->Rownd_special = true;
-        spindle_type->setEnumValue((int8_t)SpindleType::ASDA_CN1);
+        Spindles::Spindle::switch_to(SpindleType::ASDA_CN1);
         gc_state->Rownd_special = false;
     }
 
@@ -48,6 +48,7 @@ const char* const GRBL_VERSION_BUILD = "20211103";
 #include "System.h"
 
 #include "GCode.h"
+#include "Raster.h"
 #include "Planner.h"
 #include "CoolantControl.h"
 #include "Limits.h"
@@ -56,14 +57,18 @@ const char* const GRBL_VERSION_BUILD = "20211103";
 #include "Uart.h"
 #include "Serial.h"
 #include "Report.h"
+#include "RealtimeStats.h"
 #include "Pins.h"
 #include "Spindles/Spindle.h"
 #include "Motors/Motors.h"
 #include "Stepper.h"
 #include "Jog.h"
 #include "WebUI/InputBuffer.h"
+#include "NvsCache.h"
+#include "SettingsSnapshot.h"
 #include "Settings.h"
 #include "SettingsDefinitions.h"
+#include "MotionConfig.h"
 #include "WebUI/WebSettings.h"
 
 #include "UserOutput.h"
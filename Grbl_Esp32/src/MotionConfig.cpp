@@ -0,0 +1,53 @@
+/*
+  MotionConfig.cpp - Snapshot of the settings used by the planner and stepper
+  Part of Grbl_ESP32
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+
+  There are two snapshots. An update fills in the one that is not current
+  and then swaps the pointer, so a reader always sees a complete snapshot.
+  A reader that took the other snapshot before an earlier swap may still be
+  using it, so the update first waits for its reader count to drop to zero.
+  Readers hold a snapshot for at most one planner call or step pulse.
+*/
+
+#include "MotionConfig.h"
+
+MotionConfig                     motion_configs[2];
+std::atomic<const MotionConfig*> motion_config(&motion_configs[0]);
+std::atomic<uint32_t>            motion_config_readers[2];
+
+void motion_config_update() {
+    int           index = (motion_config.load() == &motion_configs[0]) ? 1 : 0;
+    MotionConfig* next  = &motion_configs[index];
+
+    while (motion_config_readers[index].load() != 0) {
+        vTaskDelay(1);
+    }
+
+    next->n_axis = number_axis->get();
+    for (int axis = 0; axis < MAX_N_AXIS; axis++) {
+        auto settings                = axis_settings[axis];
+        next->steps_per_mm[axis]     = settings->steps_per_mm->get();
+        next->inv_steps_per_mm[axis] = 1.0f / next->steps_per_mm[axis];
+        next->max_rate[axis]         = settings->max_rate->get();
+        next->acceleration[axis]     = settings->acceleration->get();
+    }
+    next->junction_deviation  = junction_deviation->get();
+    next->pulse_us            = pulse_microseconds->get();
+    next->direction_delay_us  = direction_delay_microseconds->get();
+    next->laser_power_updates = laser_power_updates->get();
+
+    motion_config.store(next);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+/*
+  MotionConfig.h - Snapshot of the settings used by the planner and stepper
+  Part of Grbl_ESP32
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Grbl.h"
+
+#include <atomic>
+
+// The planner and the step ISR read these values for every block or pulse.
+// Going through the Setting objects costs a virtual call and a few pointer
+// hops each time, so they are copied into one flat struct instead. A snapshot
+// is never modified while a reader holds it; readers take a MotionConfigRef
+// once and use it for the rest of the function.
+struct MotionConfig {
+    uint8_t n_axis;
+    float   steps_per_mm[MAX_N_AXIS];
+    float   inv_steps_per_mm[MAX_N_AXIS];
+    float   max_rate[MAX_N_AXIS];      // mm/min
+    float   acceleration[MAX_N_AXIS];  // mm/sec^2, as stored in the setting
+    float   junction_deviation;        // mm
+    int32_t pulse_us;
+    int32_t direction_delay_us;
+    int32_t laser_power_updates;  // per step segment, for M4 on acceleration ramps
+};
+
+extern MotionConfig                     motion_configs[2];
+extern std::atomic<const MotionConfig*> motion_config;
+extern std::atomic<uint32_t>            motion_config_readers[2];  // MotionConfigRefs on each snapshot
+
+// Pins the current snapshot for as long as it is in scope, so that an
+// update does not refill it underneath the reader.
+class MotionConfigRef {
+    const MotionConfig* _config;
+
+public:
+    MotionConfigRef() {
+        while (true) {
+            _config       = motion_config.load();
+            auto& readers = motion_config_readers[_config - motion_configs];
+            readers++;
+            if (motion_config.load() == _config) {
+                break;
+            }
+            readers--;  // An update swapped the snapshots in between; take the new one
+        }
+    }
+    ~MotionConfigRef() { motion_config_readers[_config - motion_configs]--; }
+
+    MotionConfigRef(const MotionConfigRef&) = delete;
+    MotionConfigRef& operator=(const MotionConfigRef&) = delete;
+
+    const MotionConfig* operator->() const { return _config; }
+};
+
+// Rebuilds the snapshot from the current settings and publishes it.
+// Called after the settings are loaded or restored and whenever one
+// of the settings it holds changes. Waits for the readers of the
+// snapshot it is about to refill, so it must run in a task.
+void motion_config_update();
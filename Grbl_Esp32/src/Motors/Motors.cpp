@@ -413,7 +413,7 @@ uint8_t motors_set_homing_mode(uint8_t homing_mask, bool isHoming) {
 }
 
 bool motors_direction(uint8_t dir_mask) {
-    auto n_axis = number_axis->get();
+    auto n_axis = MotionConfigRef()->n_axis;
     //grbl_msg_sendf(CLIENT_SERIAL, MsgLevel::Info, "motors_set_direction_pins:0x%02X", onMask);
 
     // Set the direction pins, but optimize for the common
@@ -438,7 +438,7 @@ bool motors_direction(uint8_t dir_mask) {
 }
 
 void motors_step(uint8_t step_mask) {
-    auto n_axis = number_axis->get();
+    auto n_axis = MotionConfigRef()->n_axis;
     //     grbl_msg_sendf(CLIENT_SERIAL, MsgLevel::Info, "motors_set_direction_pins:0x%02X", step_mask);
 
     // Turn on step pulses for motors that are supposed to step now
@@ -455,7 +455,7 @@ void motors_step(uint8_t step_mask) {
 }
 // Turn all stepper pins off
 void motors_unstep() {
-    auto n_axis = number_axis->get();
+    auto n_axis = MotionConfigRef()->n_axis;
     for (uint8_t axis = X_AXIS; axis < n_axis; axis++) {
         myMotor[axis][0]->unstep();
         myMotor[axis][1]->unstep();
@@ -159,12 +159,12 @@ float convert_delta_vector_to_unit_vector(float* vector) {
 }
 
 float limit_acceleration_by_axis_maximum(float* unit_vec) {
-    uint8_t idx;
-    float   limit_value = SOME_LARGE_VALUE;
-    auto    n_axis      = number_axis->get();
-    for (idx = 0; idx < n_axis; idx++) {
+    uint8_t         idx;
+    float           limit_value = SOME_LARGE_VALUE;
+    MotionConfigRef config;
+    for (idx = 0; idx < config->n_axis; idx++) {
         if (unit_vec[idx] != 0) {  // Avoid divide by zero.
-            limit_value = MIN(limit_value, fabs(axis_settings[idx]->acceleration->get() / unit_vec[idx]));
+            limit_value = MIN(limit_value, fabs(config->acceleration[idx] / unit_vec[idx]));
         }
     }
     // The acceleration setting is stored and displayed in units of mm/sec^2,
@@ -175,12 +175,12 @@ float limit_acceleration_by_axis_maximum(float* unit_vec) {
 }
 
 float limit_rate_by_axis_maximum(float* unit_vec) {
-    uint8_t idx;
-    float   limit_value = SOME_LARGE_VALUE;
-    auto    n_axis      = number_axis->get();
-    for (idx = 0; idx < n_axis; idx++) {
+    uint8_t         idx;
+    float           limit_value = SOME_LARGE_VALUE;
+    MotionConfigRef config;
+    for (idx = 0; idx < config->n_axis; idx++) {
         if (unit_vec[idx] != 0) {  // Avoid divide by zero.
-            limit_value = MIN(limit_value, fabs(axis_settings[idx]->max_rate->get() / unit_vec[idx]));
+            limit_value = MIN(limit_value, fabs(config->max_rate[idx] / unit_vec[idx]));
         }
     }
     return limit_value;
@@ -242,3 +242,13 @@ char* trim(char* str) {
 int numberOfSetBits(uint32_t i) {
     return __builtin_popcount(i);
 }
+
+uint16_t crc16_ccitt(const uint8_t* data, size_t len, uint16_t crc) {
+    while (len--) {
+        crc ^= uint16_t(*data++) << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
@@ -134,6 +134,9 @@ char*    trim(char* value);
 
 int numberOfSetBits(uint32_t i);
 
+// CRC-16/CCITT-FALSE; pass the previous result as crc to continue a calculation
+uint16_t crc16_ccitt(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF);
+
 template <class T>
 void swap(T& a, T& b) {
     T c(a);
@@ -0,0 +1,281 @@
+/*
+  NvsCache.cpp - Write-back cache for settings stored in NVS
+  Part of Grbl_ESP32
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+
+  Values are written from the protocol loop, the web server and the limit
+  task, so the table is guarded by a spinlock. The lock is only held to copy
+  an entry in or out; the flash write itself happens outside of it, so a
+  writer never waits for the flash. An entry that is written again while
+  its old value is being flushed is simply flushed again.
+*/
+
+#include "Grbl.h"
+
+#include <esp_system.h>
+
+enum class NvsOp : uint8_t {
+    None = 0,
+    SetI8,
+    SetI32,
+    SetBlob,
+    Erase,
+};
+
+const size_t NVS_CACHE_KEY_SIZE = 16;  // NVS keys are at most 15 characters
+
+typedef struct {
+    NvsOp      op;
+    nvs_handle handle;
+    char       key[NVS_CACHE_KEY_SIZE];
+    size_t     length;
+    uint8_t    value[NVS_CACHE_MAX_BLOB];
+} nvs_cache_entry_t;
+
+static nvs_cache_entry_t entries[NVS_CACHE_ENTRIES];
+static int               pending          = 0;
+static int64_t           first_write_us   = 0;
+static int64_t           last_write_us    = 0;
+static portMUX_TYPE      nvsCacheSpinlock = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t      protocolTask     = NULL;  // The only task that may sync the planner
+static const char*       through_keys[NVS_CACHE_MAX_THROUGH];
+static int               through_count = 0;
+
+static void flush_on_shutdown() {
+    nvs_cache_flush();
+}
+
+void nvs_cache_init() {
+    protocolTask = xTaskGetCurrentTaskHandle();  // Settings are set up by grbl_init()
+    esp_register_shutdown_handler(flush_on_shutdown);
+}
+
+void nvs_cache_write_through(const char* key) {
+    if (through_count < NVS_CACHE_MAX_THROUGH) {
+        through_keys[through_count++] = key;
+    }
+}
+
+static bool is_write_through(const char* key) {
+    for (int i = 0; i < through_count; i++) {
+        if (strcmp(through_keys[i], key) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Must be called with the spinlock held
+static nvs_cache_entry_t* find_entry(const char* key) {
+    for (int i = 0; i < NVS_CACHE_ENTRIES; i++) {
+        if (entries[i].op != NvsOp::None && strcmp(entries[i].key, key) == 0) {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+static nvs_cache_entry_t* free_entry() {
+    for (int i = 0; i < NVS_CACHE_ENTRIES; i++) {
+        if (entries[i].op == NvsOp::None) {
+            return &entries[i];
+        }
+    }
+    return NULL;
+}
+
+static esp_err_t write_entry(const nvs_cache_entry_t* entry) {
+    switch (entry->op) {
+        case NvsOp::SetI8:
+            return nvs_set_i8(entry->handle, entry->key, *(const int8_t*)entry->value);
+        case NvsOp::SetI32:
+            return nvs_set_i32(entry->handle, entry->key, *(const int32_t*)entry->value);
+        case NvsOp::SetBlob:
+            return nvs_set_blob(entry->handle, entry->key, entry->value, entry->length);
+        case NvsOp::Erase: {
+            esp_err_t err = nvs_erase_key(entry->handle, entry->key);
+            return err == ESP_ERR_NVS_NOT_FOUND ? ESP_OK : err;
+        }
+        default:
+            return ESP_OK;
+    }
+}
+
+static NvsType snapshot_type(NvsOp op) {
+    switch (op) {
+        case NvsOp::SetI8:
+            return NvsType::I8;
+        case NvsOp::SetI32:
+            return NvsType::I32;
+        case NvsOp::SetBlob:
+            return NvsType::Blob;
+        default:
+            return NvsType::Absent;
+    }
+}
+
+static void sync_if_protocol_task() {
+#ifdef FORCE_BUFFER_SYNC_DURING_NVS_WRITE
+    // The flash is written now; keep that out of a running job
+    if (xTaskGetCurrentTaskHandle() == protocolTask) {
+        protocol_buffer_synchronize();
+    }
+#endif
+}
+
+// Forgets a pending value for key, so a write-through cannot be overwritten by it later
+static void drop(const char* key) {
+    portENTER_CRITICAL(&nvsCacheSpinlock);
+    nvs_cache_entry_t* entry = find_entry(key);
+    if (entry) {
+        entry->op = NvsOp::None;
+        pending--;
+    }
+    portEXIT_CRITICAL(&nvsCacheSpinlock);
+}
+
+static esp_err_t write_through(NvsOp op, nvs_handle handle, const char* key, const void* value, size_t length) {
+    nvs_cache_entry_t entry;
+    entry.op     = op;
+    entry.handle = handle;
+    entry.length = length;
+    strcpy(entry.key, key);
+    if (length) {
+        memcpy(entry.value, value, length);
+    }
+    drop(key);
+    sync_if_protocol_task();
+    esp_err_t err = write_entry(&entry);
+    return err ? err : nvs_commit(handle);
+}
+
+static esp_err_t record(NvsOp op, nvs_handle handle, const char* key, const void* value, size_t length) {
+    if (strlen(key) >= NVS_CACHE_KEY_SIZE) {
+        return ESP_ERR_NVS_KEY_TOO_LONG;
+    }
+    snapshot_note(handle, key, snapshot_type(op), value, length);
+    if (is_write_through(key)) {
+        return write_through(op, handle, key, value, length);
+    }
+    while (true) {
+        portENTER_CRITICAL(&nvsCacheSpinlock);
+        nvs_cache_entry_t* entry = find_entry(key);
+        if (!entry && (entry = free_entry()) != NULL) {
+            strcpy(entry->key, key);
+            if (pending++ == 0) {
+                first_write_us = esp_timer_get_time();
+            }
+        }
+        if (entry) {
+            entry->op     = op;
+            entry->handle = handle;
+            entry->length = length;
+            if (length) {
+                memcpy(entry->value, value, length);
+            }
+            last_write_us = esp_timer_get_time();
+            portEXIT_CRITICAL(&nvsCacheSpinlock);
+            return ESP_OK;
+        }
+        portEXIT_CRITICAL(&nvsCacheSpinlock);
+        sync_if_protocol_task();
+        nvs_cache_flush();  // The table is full, so make room
+    }
+}
+
+esp_err_t nvs_cache_set_i8(nvs_handle handle, const char* key, int8_t value) {
+    return record(NvsOp::SetI8, handle, key, &value, sizeof(value));
+}
+
+esp_err_t nvs_cache_set_i32(nvs_handle handle, const char* key, int32_t value) {
+    return record(NvsOp::SetI32, handle, key, &value, sizeof(value));
+}
+
+esp_err_t nvs_cache_set_blob(nvs_handle handle, const char* key, const void* value, size_t length) {
+    if (length > NVS_CACHE_MAX_BLOB) {
+        snapshot_note(handle, key, NvsType::Blob, value, length);
+        drop(key);
+        return nvs_set_blob(handle, key, value, length);
+    }
+    return record(NvsOp::SetBlob, handle, key, value, length);
+}
+
+// Strings are long and rarely changed, so they are written through
+esp_err_t nvs_cache_set_str(nvs_handle handle, const char* key, const char* value) {
+    snapshot_note(handle, key, NvsType::Str, value, strlen(value) + 1);
+    drop(key);
+    return nvs_set_str(handle, key, value);
+}
+
+esp_err_t nvs_cache_erase_key(nvs_handle handle, const char* key) {
+    return record(NvsOp::Erase, handle, key, NULL, 0);
+}
+
+esp_err_t nvs_cache_erase_key_now(nvs_handle handle, const char* key) {
+    drop(key);
+    esp_err_t err = nvs_erase_key(handle, key);
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        return ESP_OK;
+    }
+    return err ? err : nvs_commit(handle);
+}
+
+void nvs_cache_flush() {
+    for (int i = 0; i < NVS_CACHE_ENTRIES; i++) {
+        nvs_cache_entry_t copy;
+        portENTER_CRITICAL(&nvsCacheSpinlock);
+        copy = entries[i];
+        if (copy.op != NvsOp::None) {
+            entries[i].op = NvsOp::None;
+            pending--;
+        }
+        portEXIT_CRITICAL(&nvsCacheSpinlock);
+        if (copy.op != NvsOp::None) {
+            if (esp_err_t err = write_entry(&copy)) {
+                grbl_msg_sendf(CLIENT_SERIAL, MsgLevel::Error, "NVS write of %s failed with error %d", copy.key, err);
+            }
+        }
+    }
+}
+
+void nvs_cache_clear() {
+    portENTER_CRITICAL(&nvsCacheSpinlock);
+    for (int i = 0; i < NVS_CACHE_ENTRIES; i++) {
+        entries[i].op = NvsOp::None;
+    }
+    pending = 0;
+    portEXIT_CRITICAL(&nvsCacheSpinlock);
+}
+
+int nvs_cache_pending() {
+    return pending;
+}
+
+void nvs_cache_poll() {
+    if (!pending) {
+        return;
+    }
+    int64_t now     = esp_timer_get_time();
+    bool    overdue = now - first_write_us >= NVS_CACHE_DEADLINE_MS * 1000LL;
+#ifdef FORCE_BUFFER_SYNC_DURING_NVS_WRITE
+    // Keep flash writes out of running jobs until the deadline; see Config.h
+    if (!overdue && (plan_get_current_block() || sys.state == State::Cycle || sys.state == State::Homing || sys.state == State::Jog)) {
+        return;
+    }
+#endif
+    if (overdue || now - last_write_us >= NVS_CACHE_IDLE_MS * 1000LL) {
+        nvs_cache_flush();
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+/*
+  NvsCache.h - Write-back cache for settings stored in NVS
+  Part of Grbl_ESP32
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <nvs.h>
+#include <cstddef>
+#include <cstdint>
+
+// The nvs_cache_ calls take the place of the nvs_set_ and nvs_erase_key
+// calls of the same name. They only record the new value, so they return
+// right away and never fail for lack of flash. A key that is written again
+// before it is flushed costs a single flash write.
+//
+// Pending values are written out by nvs_cache_poll() once nothing has been
+// written for NVS_CACHE_IDLE_MS, or NVS_CACHE_DEADLINE_MS after the oldest
+// pending write, and always before a restart. With
+// FORCE_BUFFER_SYNC_DURING_NVS_WRITE a job only writes them at a planner
+// buffer sync or once the deadline has passed, and syncs first if the table
+// is full.
+//
+// Keys given to nvs_cache_write_through(), like the coordinate offsets and
+// the active tool, must survive a power loss, so they are written and
+// committed right away, after a planner buffer sync with
+// FORCE_BUFFER_SYNC_DURING_NVS_WRITE.
+//
+// A tool table edit (ToolNfo::set_xyz) records MAX_N_AXIS + 1 keys, so the
+// table holds several of them.
+//
+// Reads still go straight to NVS, so a key must not be read back with
+// nvs_get_ while it is pending. Settings are only read from NVS at startup.
+const int    NVS_CACHE_ENTRIES     = 64;
+const size_t NVS_CACHE_MAX_BLOB    = 32;  // larger values are written through
+const int    NVS_CACHE_IDLE_MS     = 250;
+const int    NVS_CACHE_DEADLINE_MS = 5000;
+const int    NVS_CACHE_MAX_THROUGH = 16;  // keys that nvs_cache_write_through() can take
+
+void nvs_cache_init();
+
+// Makes the writes of key bypass the cache. Called while the settings are set
+// up; key must stay valid.
+void nvs_cache_write_through(const char* key);
+
+esp_err_t nvs_cache_set_i8(nvs_handle handle, const char* key, int8_t value);
+esp_err_t nvs_cache_set_i32(nvs_handle handle, const char* key, int32_t value);
+esp_err_t nvs_cache_set_str(nvs_handle handle, const char* key, const char* value);
+esp_err_t nvs_cache_set_blob(nvs_handle handle, const char* key, const void* value, size_t length);
+esp_err_t nvs_cache_erase_key(nvs_handle handle, const char* key);
+
+// Erases key from flash right away and forgets any pending value for it, for
+// a key that must be gone before any later write can reach flash
+esp_err_t nvs_cache_erase_key_now(nvs_handle handle, const char* key);
+
+// Called from the protocol loop and at each planner buffer sync; flushes when
+// the idle time or deadline has passed
+void nvs_cache_poll();
+
+// Writes every pending value now
+void nvs_cache_flush();
+
+// Drops every pending value, for when the whole namespace is erased
+void nvs_cache_clear();
+
+int nvs_cache_pending();
@@ -31,6 +31,7 @@ static uint8_t      block_buffer_tail;                // Index of the block to p
 static uint8_t      block_buffer_head;                // Index of the next block to be pushed
 static uint8_t      next_buffer_head;                 // Index of the next buffer head
 static uint8_t      block_buffer_planned;             // Index of the optimally planned block
+static RasterLine   raster_lines[BLOCK_BUFFER_SIZE];  // Pixels of raster blocks, indexed like block_buffer
 
 // Define planner variables
 typedef struct {
@@ -244,6 +245,31 @@ uint8_t plan_check_full_buffer() {
     return block_buffer_tail == next_buffer_head;
 }
 
+float plan_surface_speed_rpm(plan_block_t* block, float mm_remaining) {
+    float radius = block->radius - block->radius_per_mm * mm_remaining;
+    float rpm    = block->surface_speed / (2 * M_PI * fabsf(radius));
+    return rpm < block->max_spindle_speed ? rpm : block->max_spindle_speed;
+}
+
+// The spindle RPM that a G95 feed per revolution is multiplied by. This is the commanded speed
+// with the spindle override, held to the range of the active spindle as it does itself, so an
+// override change rescales the feed. With G96, it is the lower speed of both ends of what is
+// left of the block, so the feed per revolution is never exceeded.
+static float plan_feed_rpm(plan_block_t* block) {
+    float rpm = block->spindle_speed;
+    if (block->surface_speed > 0) {
+        rpm = MIN(plan_surface_speed_rpm(block, block->millimeters), plan_surface_speed_rpm(block, 0.0));
+    }
+    rpm *= (0.01 * sys.spindle_speed_ovr);
+    if (rpm > spindle->max_rpm()) {
+        return spindle->max_rpm();
+    }
+    if (rpm > 0 && rpm < spindle->min_rpm()) {
+        return spindle->min_rpm();
+    }
+    return rpm;
+}
+
 // Computes and returns block nominal speed based on running condition and override values.
 // NOTE: All system motion commands, such as homing/parking, are not subject to overrides.
 float plan_compute_profile_nominal_speed(plan_block_t* block) {
@@ -251,6 +277,9 @@ float plan_compute_profile_nominal_speed(plan_block_t* block) {
     if (block->motion.rapidMotion) {
         nominal_speed *= (0.01 * sys.r_override);
     } else {
+        if (block->motion.feedPerRev) {
+            nominal_speed *= plan_feed_rpm(block);
+        }
         if (!(block->motion.noFeedOverride)) {
             nominal_speed *= (0.01 * sys.f_override);
         }
@@ -295,6 +324,15 @@ void plan_update_velocity_profile_parameters() {
     pl.previous_nominal_speed = prev_nominal_speed;  // Update prev nominal speed for next incoming block.
 }
 
+bool plan_has_feed_per_rev_block() {
+    for (uint8_t block_index = block_buffer_tail; block_index != block_buffer_head; block_index = plan_next_block_index(block_index)) {
+        if (block_buffer[block_index].motion.feedPerRev) {
+            return true;
+        }
+    }
+    return false;
+}
+
 uint8_t plan_buffer_line(float* target, plan_line_data_t* pl_data) {
     // Prepare and initialize new block. Copy relevant pl_data for block execution.
     plan_block_t* block = &block_buffer[block_buffer_head];
@@ -317,15 +355,16 @@ uint8_t plan_buffer_line(float* target, plan_line_data_t* pl_data) {
     } else {
         memcpy(position_steps, pl.position, sizeof(pl.position));
     }
-    auto n_axis = number_axis->get();
+    MotionConfigRef config;
+    auto            n_axis = config->n_axis;
     for (idx = 0; idx < n_axis; idx++) {
         // Calculate target position in absolute steps, number of steps for each axis, and determine max step events.
         // Also, compute individual axes distance for move and prep unit vector calculations.
         // NOTE: Computes true distance from converted step values.
-        target_steps[idx]       = lround(target[idx] * axis_settings[idx]->steps_per_mm->get());
+        target_steps[idx]       = lround(target[idx] * config->steps_per_mm[idx]);
         block->steps[idx]       = labs(target_steps[idx] - position_steps[idx]);
         block->step_event_count = MAX(block->step_event_count, block->steps[idx]);
-        delta_mm                = (target_steps[idx] - position_steps[idx]) / axis_settings[idx]->steps_per_mm->get();
+        delta_mm                = (target_steps[idx] - position_steps[idx]) * config->inv_steps_per_mm[idx];
         unit_vec[idx]           = delta_mm;  // Store unit vector numerator
         // Set direction bits. Bit enabled always means direction is negative.
         if (delta_mm < 0.0) {
@@ -336,6 +375,10 @@ uint8_t plan_buffer_line(float* target, plan_line_data_t* pl_data) {
     if (block->step_event_count == 0) {
         return PLAN_EMPTY_BLOCK;
     }
+    if (pl_data->raster) {
+        raster_lines[block_buffer_head] = *pl_data->raster;
+        block->raster                   = &raster_lines[block_buffer_head];
+    }
 
     // Calculate the unit vector of the line move and the block maximum feed rate and acceleration scaled
     // down such that no individual axes maximum values are exceeded with respect to the line direction.
@@ -345,6 +388,13 @@ uint8_t plan_buffer_line(float* target, plan_line_data_t* pl_data) {
     block->acceleration = limit_acceleration_by_axis_maximum(unit_vec);
     block->rapid_rate   = limit_rate_by_axis_maximum(unit_vec);
 
+    if (pl_data->surface_speed > 0) {
+        block->surface_speed     = pl_data->surface_speed;
+        block->max_spindle_speed = pl_data->max_spindle_speed;
+        block->radius            = target[X_AXIS] - pl_data->spindle_axis_x;
+        block->radius_per_mm     = unit_vec[X_AXIS];
+    }
+
     // Store programmed rate.
     if (block->motion.rapidMotion) {
         block->programmed_rate = block->rapid_rate;
@@ -402,7 +452,7 @@ uint8_t plan_buffer_line(float* target, plan_line_data_t* pl_data) {
                 float sin_theta_d2          = sqrt(0.5 * (1.0 - junction_cos_theta));  // Trig half angle identity. Always positive.
                 block->max_junction_speed_sqr =
                     MAX(MINIMUM_JUNCTION_SPEED * MINIMUM_JUNCTION_SPEED,
-                        (junction_acceleration * junction_deviation->get() * sin_theta_d2) / (1.0 - sin_theta_d2));
+                        (junction_acceleration * config->junction_deviation * sin_theta_d2) / (1.0 - sin_theta_d2));
             }
         }
     }
@@ -43,6 +43,7 @@ struct PlMotion {
     uint8_t systemMotion : 1;    // Single motion. Circumvents planner state. Used by home/park.
     uint8_t noFeedOverride : 1;  // Motion does not honor feed override.
     uint8_t inverseTime : 1;     // Interprets feed rate value as inverse time when set.
+    uint8_t feedPerRev : 1;      // Interprets feed rate value as distance per spindle revolution when set.
 };
 
 // This struct stores a linear movement of a g-code block motion with its critical "nominal" values
@@ -79,6 +80,14 @@ typedef struct {
     // Stored spindle speed data used by spindle overrides and resuming methods.
     float spindle_speed;  // Block spindle speed. Copied from pl_line_data.
     //#endif
+
+    const RasterLine* raster;  // Pixel powers of a $Raster line, or NULL
+
+    // G96 constant surface speed. The stepper sets the spindle RPM from the X radius.
+    float surface_speed;      // At the cutting edge in (mm/min), or 0 for a fixed spindle speed
+    float max_spindle_speed;  // RPM limit, from G96 D
+    float radius;             // X distance from the spindle axis at the end of the block (mm)
+    float radius_per_mm;      // Change of the radius per mm traveled, from the end of the block
 } plan_block_t;
 
 // Planner data prototype. Must be used when passing new motions to the planner.
@@ -91,7 +100,11 @@ typedef struct {
 #ifdef USE_LINE_NUMBERS
     int32_t line_number;  // Desired line number to report when executing.
 #endif
-    bool         is_jog;         // true if this was generated due to a jog command
+    bool              is_jog;             // true if this was generated due to a jog command
+    const RasterLine* raster;             // Pixel powers to copy into the block, or NULL
+    float             surface_speed;      // G96 surface speed (mm/min), or 0
+    float             max_spindle_speed;  // G96 RPM limit
+    float             spindle_axis_x;     // Machine X of the spindle axis for G96
 } plan_line_data_t;
 
 // Initialize and reset the motion plan subsystem
@@ -122,9 +135,15 @@ float plan_get_exec_block_exit_speed_sqr();
 // Called by main program during planner calculations and step segment buffer during initialization.
 float plan_compute_profile_nominal_speed(plan_block_t* block);
 
+// The G96 spindle RPM for a block at mm_remaining from its end
+float plan_surface_speed_rpm(plan_block_t* block, float mm_remaining);
+
 // Re-calculates buffered motions profile parameters upon a motion-based override change.
 void plan_update_velocity_profile_parameters();
 
+// Returns true if any queued block is a G95 feed per revolution, whose speed follows the spindle override.
+bool plan_has_feed_per_rev_block();
+
 // Reset the planner position vector (in steps)
 void plan_sync_position();
 
@@ -1,6 +1,7 @@
 #include "Grbl.h"
 #include <map>
 #include "Regex.h"
+#include "Spindles/VFDSpindle.h"
 
 // WG Readable and writable as guest
 // WU Readable and writable as user and admin
@@ -55,6 +56,7 @@ void settings_restore(uint8_t restore_flag) {
                 }
             }
         }
+        motion_config_update();
         grbl_msg_sendf(CLIENT_SERIAL, MsgLevel::Info, "Settings reset done");
     }
     if (restore_flag & SettingsRestore::Parameters) {
@@ -70,6 +72,7 @@ void load_settings() {
     for (Setting* s = Setting::List; s; s = s->next()) {
         s->load();
     }
+    motion_config_update();
 }
 
 extern void make_settings();
@@ -80,10 +83,14 @@ namespace WebUI {
 }
 
 void settings_init() {
+    int64_t start_us = esp_timer_get_time();
+    Setting::init();
+    snapshot_begin(Setting::_handle);
     make_settings();
     WebUI::make_web_settings();
     make_grbl_commands();
     load_settings();
+    snapshot_end(start_us);
 }
 
 // TODO Settings - jog may need to be special-cased in the parser, since
@@ -216,6 +223,80 @@ Error disable_alarm_lock(const char* value, WebUI::AuthenticationLevel auth_leve
     }  // Otherwise, no effect.
     return Error::Ok;
 }
+Error stream_mode(const char* value, WebUI::AuthenticationLevel auth_level, WebUI::ESPResponseStream* out) {
+    if (!value) {
+        grbl_sendf(out->client(), "[Stream/Mode=%s]\r\n", protocol_get_stream_mode(out->client()) ? "ON" : "OFF");
+        return Error::Ok;
+    }
+    if (!strcasecmp(value, "ON") || !strcmp(value, "1")) {
+        return protocol_set_stream_mode(out->client(), true);
+    }
+    if (!strcasecmp(value, "OFF") || !strcmp(value, "0")) {
+        return protocol_set_stream_mode(out->client(), false);
+    }
+    return Error::InvalidValue;
+}
+Error report_interval(const char* value, WebUI::AuthenticationLevel auth_level, WebUI::ESPResponseStream* out) {
+    if (!value) {
+        grbl_sendf(out->client(), "[Report/Interval=%d]\r\n", report_get_auto_interval(out->client()));
+        return Error::Ok;
+    }
+    char*    end;
+    uint32_t interval_ms = strtoul(value, &end, 10);
+    if (*end != '\0' || end == value) {
+        return Error::BadNumberFormat;
+    }
+    return report_set_auto_interval(out->client(), interval_ms);
+}
+Error report_binary(const char* value, WebUI::AuthenticationLevel auth_level, WebUI::ESPResponseStream* out) {
+    if (!value) {
+        grbl_sendf(out->client(), "[Report/Binary=%s]\r\n", report_get_binary_status(out->client()) ? "ON" : "OFF");
+        return Error::Ok;
+    }
+    if (!strcasecmp(value, "ON") || !strcmp(value, "1")) {
+        return report_set_binary_status(out->client(), true);
+    }
+    if (!strcasecmp(value, "OFF") || !strcmp(value, "0")) {
+        return report_set_binary_status(out->client(), false);
+    }
+    return Error::InvalidValue;
+}
+Error settings_export(const char* value, WebUI::AuthenticationLevel auth_level, WebUI::ESPResponseStream* out) {
+    snapshot_export(out->client());
+    return Error::Ok;
+}
+Error settings_import(const char* value, WebUI::AuthenticationLevel auth_level, WebUI::ESPResponseStream* out) {
+    if (!value) {
+        return Error::InvalidStatement;
+    }
+    return snapshot_import(value);
+}
+Error realtime_stats(const char* value, WebUI::AuthenticationLevel auth_level, WebUI::ESPResponseStream* out) {
+    if (!value) {
+        rt_stats_report(out->client());
+        return Error::Ok;
+    }
+    if (!strcasecmp(value, "CLEAR")) {
+        rt_stats_clear();
+        return Error::Ok;
+    }
+    return Error::InvalidValue;
+}
+Error vfd_stats(const char* value, WebUI::AuthenticationLevel auth_level, WebUI::ESPResponseStream* out) {
+    if (!value) {
+        Spindles::VFD::report_stats(out->client());
+        return Error::Ok;
+    }
+    if (!strcasecmp(value, "CLEAR")) {
+        Spindles::VFD::clear_stats();
+        return Error::Ok;
+    }
+    return Error::InvalidValue;
+}
+Error report_client_stats(const char* value, WebUI::AuthenticationLevel auth_level, WebUI::ESPResponseStream* out) {
+    client_report_tx_stats(out->client());
+    return Error::Ok;
+}
 Error report_ngc(const char* value, WebUI::AuthenticationLevel auth_level, WebUI::ESPResponseStream* out) {
     report_ngc_parameters(out->client());
     return Error::Ok;
@@ -332,6 +413,10 @@ Error doJog(const char* value, WebUI::AuthenticationLevel auth_level, WebUI::ESP
     return gc_execute_line(jogLine, out->client());
 }
 
+Error raster(const char* value, WebUI::AuthenticationLevel auth_level, WebUI::ESPResponseStream* out) {
+    return raster_execute(value);
+}
+
 const char* alarmString(ExecAlarm alarmNumber) {
     auto it = AlarmNames.find(alarmNumber);
     return it == AlarmNames.end() ? NULL : it->second;
@@ -463,6 +548,7 @@ void make_grbl_commands() {
     new GrblCommand("", "Help", show_grbl_help, anyState);
     new GrblCommand("T", "State", showState, anyState);
     new GrblCommand("J", "Jog", doJog, idleOrJog);
+    new GrblCommand(NULL, "Raster", raster, anyState);
 
     new GrblCommand("$", "GrblSettings/List", report_normal_settings, notCycleOrHold);
     new GrblCommand("+", "ExtendedSettings/List", report_extended_settings, notCycleOrHold);
@@ -475,8 +561,16 @@ void make_grbl_commands() {
     new GrblCommand("G", "GCode/Modes", report_gcode, anyState);
     new GrblCommand("C", "GCode/Check", toggle_check_mode, anyState);
     new GrblCommand("X", "Alarm/Disable", disable_alarm_lock, anyState);
+    new GrblCommand(NULL, "Stream/Mode", stream_mode, anyState);
+    new GrblCommand(NULL, "Clients/Stats", report_client_stats, anyState);
+    new GrblCommand(NULL, "Stats/Realtime", realtime_stats, anyState);
+    new GrblCommand(NULL, "VFD/Stats", vfd_stats, anyState);
+    new GrblCommand(NULL, "Report/Interval", report_interval, anyState);
+    new GrblCommand(NULL, "Report/Binary", report_binary, anyState);
     new GrblCommand("NVX", "Settings/Erase", Setting::eraseNVS, idleOrAlarm, WA);
     new GrblCommand("V", "Settings/Stats", Setting::report_nvs_stats, idleOrAlarm);
+    new GrblCommand(NULL, "Settings/Export", settings_export, idleOrAlarm);
+    new GrblCommand(NULL, "Settings/Import", settings_import, idleOrAlarm, WA);
     new GrblCommand("#", "GCode/Offsets", report_ngc, idleOrAlarm);
     new GrblCommand("H", "Home", home_all, idleOrAlarm);
     new GrblCommand("MD", "Motor/Disable", motor_disable, idleOrAlarm);
@@ -528,6 +622,114 @@ char* normalize_key(char* start) {
     return start;
 }
 
+// Hash index over the names of all settings and commands, so a lookup takes a
+// few string compares instead of walking both lists. It uses open addressing
+// with linear probing and is built on first use. Settings and commands are
+// only ever added at the head of their lists, so a changed head means
+// something was registered later and the index is rebuilt.
+enum class WordKind : uint8_t {
+    SettingName = 0,  // Lower kinds take precedence when a name is found more than once
+    SettingGrblName,
+    CommandName,
+    CommandGrblName,
+};
+static Word**    word_index       = NULL;
+static WordKind* word_index_kinds = NULL;
+static uint32_t  word_index_mask  = 0;
+static Setting*  indexed_settings = NULL;
+static Command*  indexed_commands = NULL;
+
+// FNV-1a of the name ignoring case
+static uint32_t word_name_hash(const char* name) {
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash ^= uint8_t(tolower(*name++));
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static const char* word_index_name(uint32_t slot) {
+    switch (word_index_kinds[slot]) {
+        case WordKind::SettingGrblName:
+        case WordKind::CommandGrblName:
+            return word_index[slot]->getGrblName();
+        default:
+            return word_index[slot]->getName();
+    }
+}
+
+// The first entry for a name wins, as the list walk used to find it first
+static void word_index_add(const char* name, Word* word, WordKind kind) {
+    if (!name) {
+        return;
+    }
+    for (uint32_t slot = word_name_hash(name) & word_index_mask;; slot = (slot + 1) & word_index_mask) {
+        if (!word_index[slot]) {
+            word_index[slot]       = word;
+            word_index_kinds[slot] = kind;
+            return;
+        }
+        if (word_index_kinds[slot] == kind && strcasecmp(word_index_name(slot), name) == 0) {
+            return;
+        }
+    }
+}
+
+static bool word_index_build() {
+    uint32_t names = 0;
+    for (Setting* s = Setting::List; s; s = s->next()) {
+        names += s->getGrblName() ? 2 : 1;
+    }
+    for (Command* cp = Command::List; cp; cp = cp->next()) {
+        names += cp->getGrblName() ? 2 : 1;
+    }
+    uint32_t size = 16;
+    while (size < names * 2) {  // Keep the load factor under one half
+        size <<= 1;
+    }
+    free(word_index);
+    free(word_index_kinds);
+    word_index       = (Word**)calloc(size, sizeof(Word*));
+    word_index_kinds = (WordKind*)malloc(size * sizeof(WordKind));
+    if (!word_index || !word_index_kinds) {
+        free(word_index);
+        free(word_index_kinds);
+        word_index       = NULL;
+        word_index_kinds = NULL;
+        return false;
+    }
+    word_index_mask = size - 1;
+    for (Setting* s = Setting::List; s; s = s->next()) {
+        word_index_add(s->getName(), s, WordKind::SettingName);
+        word_index_add(s->getGrblName(), s, WordKind::SettingGrblName);
+    }
+    for (Command* cp = Command::List; cp; cp = cp->next()) {
+        word_index_add(cp->getName(), cp, WordKind::CommandName);
+        word_index_add(cp->getGrblName(), cp, WordKind::CommandGrblName);
+    }
+    indexed_settings = Setting::List;
+    indexed_commands = Command::List;
+    return true;
+}
+
+// Returns the setting or command called key, or NULL
+static Word* find_word(const char* key, WordKind& kind) {
+    if (!word_index || indexed_settings != Setting::List || indexed_commands != Command::List) {
+        if (!word_index_build()) {
+            return NULL;
+        }
+    }
+    Word* found = NULL;
+    for (uint32_t slot = word_name_hash(key) & word_index_mask; word_index[slot]; slot = (slot + 1) & word_index_mask) {
+        if ((!found || word_index_kinds[slot] < kind) && strcasecmp(word_index_name(slot), key) == 0) {
+            found = word_index[slot];
+            kind  = word_index_kinds[slot];
+        }
+    }
+    return found;
+}
+
 // This is the handler for all forms of settings commands,
 // $..= and [..], with and without a value.
 Error do_command_or_setting(const char* key, char* value, WebUI::AuthenticationLevel auth_level, WebUI::ESPResponseStream* out) {
@@ -537,47 +739,30 @@ Error do_command_or_setting(const char* key, char* value, WebUI::AuthenticationL
     // $key= with nothing following the = .  It is important to distinguish
     // those cases so that you can say "$N0=" to clear a startup line.
 
-    // First search the settings list by text name.  If found, set a new
-    // value if one is given, otherwise display the current value
-    for (Setting* s = Setting::List; s; s = s->next()) {
-        if (strcasecmp(s->getName(), key) == 0) {
-            if (auth_failed(s, value, auth_level)) {
-                return Error::AuthenticationFailed;
-            }
-            if (value) {
-                return s->setStringValue(value);
-            } else {
-                show_setting(s->getName(), s->getStringValue(), NULL, out);
-                return Error::Ok;
-            }
+    // Settings take precedence over commands, and a setting's text name over
+    // another's compatible name. If a setting is found, set a new value if one
+    // is given, otherwise display the current value.
+    WordKind kind;
+    Word*    word = find_word(key, kind);
+    if (word) {
+        if (auth_failed(word, value, auth_level)) {
+            return Error::AuthenticationFailed;
         }
-    }
-
-    // Then search the setting list by compatible name.  If found, set a new
-    // value if one is given, otherwise display the current value in compatible mode
-    for (Setting* s = Setting::List; s; s = s->next()) {
-        if (s->getGrblName() && strcasecmp(s->getGrblName(), key) == 0) {
-            if (auth_failed(s, value, auth_level)) {
-                return Error::AuthenticationFailed;
-            }
-            if (value) {
-                return s->setStringValue(value);
-            } else {
-                show_setting(s->getGrblName(), s->getCompatibleValue(), NULL, out);
-                return Error::Ok;
-            }
+        if (kind == WordKind::CommandName || kind == WordKind::CommandGrblName) {
+            // Commands handle values internally; you cannot determine whether
+            // to set or display solely based on the presence of a value.
+            return static_cast<Command*>(word)->action(value, auth_level, out);
         }
-    }
-    // If we did not find a setting, look for a command.  Commands
-    // handle values internally; you cannot determine whether to set
-    // or display solely based on the presence of a value.
-    for (Command* cp = Command::List; cp; cp = cp->next()) {
-        if ((strcasecmp(cp->getName(), key) == 0) || (cp->getGrblName() && strcasecmp(cp->getGrblName(), key) == 0)) {
-            if (auth_failed(cp, value, auth_level)) {
-                return Error::AuthenticationFailed;
-            }
-            return cp->action(value, auth_level, out);
+        Setting* s = static_cast<Setting*>(word);
+        if (value) {
+            return s->setStringValue(value);
         }
+        if (kind == WordKind::SettingGrblName) {
+            show_setting(s->getGrblName(), s->getCompatibleValue(), NULL, out);  // compatible mode
+        } else {
+            show_setting(s->getName(), s->getStringValue(), NULL, out);
+        }
+        return Error::Ok;
     }
 
     // If we did not find an exact match and there is no value,
@@ -32,46 +32,92 @@ static uint8_t line_flags           = 0;
 static uint8_t char_counter         = 0;
 static uint8_t comment_char_counter = 0;
 
+// Batched acknowledgement streaming. A client that turns it on with $Stream/Mode=ON may send
+// lines of the form "@<seq>:<crc>:<text>". <seq> counts up by one from 1 and <crc> is the
+// CRC-16/CCITT of <text> in hex. Successful lines are acknowledged together with "ack:<seq>"
+// once $Stream/AckLines lines are waiting or the oldest has waited $Stream/AckMs. A failed
+// line is answered at once with "err:<seq>,<code>", which also acknowledges it. A corrupt or
+// out of order line gets "rs:<seq>", asking the host to resend from <seq>; later lines are
+// dropped until that one arrives. Lines without the prefix keep the ok/error responses.
 typedef struct {
-    char buffer[LINE_BUFFER_SIZE];
-    int  len;
-    int  line_number;
-} client_line_t;
-client_line_t client_lines[CLIENT_COUNT];
+    bool     enabled;
+    bool     resync;     // waiting for the host to resend next_seq
+    uint32_t next_seq;   // sequence number expected next
+    uint32_t done_seq;   // last sequence number executed
+    uint32_t acked_seq;  // last sequence number acknowledged to the host
+    uint32_t done_ms;    // when the oldest unacknowledged line finished
+} client_stream_t;
+static client_stream_t client_streams[CLIENT_COUNT];
 
-static void empty_line(uint8_t client) {
-    client_line_t* cl = &client_lines[client];
-    cl->len           = 0;
-    cl->buffer[0]     = '\0';
+Error protocol_set_stream_mode(uint8_t client, bool enable) {
+    if (client >= CLIENT_COUNT) {
+        return Error::InvalidValue;
+    }
+    client_stream_t* cs = &client_streams[client];
+    cs->enabled         = enable;
+    cs->resync          = false;
+    cs->next_seq        = 1;
+    cs->done_seq        = 0;
+    cs->acked_seq       = 0;
+    return Error::Ok;
+}
+
+bool protocol_get_stream_mode(uint8_t client) {
+    return client < CLIENT_COUNT && client_streams[client].enabled;
+}
+
+static void stream_send_ack(uint8_t client) {
+    client_stream_t* cs = &client_streams[client];
+    if (cs->done_seq != cs->acked_seq) {
+        grbl_sendf(client, "ack:%u\r\n", cs->done_seq);
+        cs->acked_seq = cs->done_seq;
+    }
 }
-static void empty_lines() {
+
+// Sends acknowledgements that have waited long enough
+static void stream_poll_acks() {
     for (uint8_t client = 0; client < CLIENT_COUNT; client++) {
-        empty_line(client);
+        client_stream_t* cs = &client_streams[client];
+        if (cs->enabled && cs->done_seq != cs->acked_seq && (millis() - cs->done_ms) >= uint32_t(stream_ack_ms->get())) {
+            stream_send_ack(client);
+        }
     }
 }
 
-Error add_char_to_line(char c, uint8_t client) {
-    client_line_t* cl = &client_lines[client];
-    // Simple editing for interactive input
-    if (c == '\b') {
-        // Backspace erases
-        if (cl->len) {
-            --cl->len;
-            cl->buffer[cl->len] = '\0';
+static void stream_execute_line(char* line, uint8_t client) {
+    client_stream_t* cs = &client_streams[client];
+    char*            end;
+    uint32_t         seq  = strtoul(line + 1, &end, 10);
+    uint16_t         crc  = 0;
+    char*            text = NULL;
+    if (*end == ':') {
+        crc = strtoul(end + 1, &end, 16);
+        if (*end == ':') {
+            text = end + 1;
         }
-        return Error::Ok;
     }
-    if (cl->len == (LINE_BUFFER_SIZE - 1)) {
-        return Error::Overflow;
+    if (!text || seq != cs->next_seq || crc != crc16_ccitt((const uint8_t*)text, strlen(text))) {
+        if (!cs->resync) {
+            stream_send_ack(client);
+            grbl_sendf(client, "rs:%u\r\n", cs->next_seq);
+            cs->resync = true;
+        }
+        return;
     }
-    if (c == '\r' || c == '\n') {
-        cl->len = 0;
-        cl->line_number++;
-        return Error::Eol;
+    cs->resync = false;
+    cs->next_seq++;
+
+    Error status = execute_line(text, client, WebUI::AuthenticationLevel::LEVEL_GUEST);
+    if (cs->done_seq == cs->acked_seq) {
+        cs->done_ms = millis();
+    }
+    cs->done_seq = seq;
+    if (status != Error::Ok) {
+        cs->acked_seq = seq;  // err: acknowledges the line
+        grbl_sendf(client, "err:%u,%d\r\n", seq, static_cast<int>(status));
+    } else if (cs->done_seq - cs->acked_seq >= uint32_t(stream_ack_lines->get())) {
+        stream_send_ack(client);
     }
-    cl->buffer[cl->len++] = c;
-    cl->buffer[cl->len]   = '\0';
-    return Error::Ok;
 }
 
 Error execute_line(char* line, uint8_t client, WebUI::AuthenticationLevel auth_level) {
@@ -103,7 +149,6 @@ bool can_park() {
 */
 void protocol_main_loop() {
     client_reset_read_buffer(CLIENT_ALL);
-    empty_lines();
     //uint8_t client = CLIENT_SERIAL; // default client
     // Perform some machine checks to make sure everything is good to go.
 #ifdef CHECK_LIMITS_AT_INIT
@@ -134,7 +179,6 @@ void protocol_main_loop() {
     // Primary loop! Upon a system abort, this exits back to main() to reset the system.
     // This is also where Grbl idles while waiting for something to do.
     // ---------------------------------------------------------------------------------
-    int c;
     for (;;) {
 #ifdef ENABLE_SD_CARD
         if (SD_ready_next) {
@@ -150,39 +194,34 @@ void protocol_main_loop() {
             }
         }
 #endif
-        // Receive one line of incoming serial data, as the data becomes available.
+        // Receive complete lines of incoming data, as they become available. The client
+        // task frames the lines, so there is no per-character work here.
         // Filtering, if necessary, is done later in gc_execute_line(), so the
         // filtering is the same with serial and file input.
         uint8_t client = CLIENT_SERIAL;
-        char*   line;
         for (client = 0; client < CLIENT_COUNT; client++) {
-            while ((c = client_read(client)) != -1) {
-                Error res = add_char_to_line(c, client);
-                switch (res) {
-                    case Error::Ok:
-                        break;
-                    case Error::Eol:
-                        protocol_execute_realtime();  // Runtime command check point.
-                        if (sys.abort) {
-                            return;  // Bail to calling function upon system abort
-                        }
-                        line = client_lines[client].buffer;
+            Error res;
+            while ((res = client_read_line(client, line)) != Error::Ok) {
+                if (res == Error::Overflow) {
+                    report_status_message(Error::Overflow, client);
+                    continue;
+                }
+                protocol_execute_realtime();  // Runtime command check point.
+                if (sys.abort) {
+                    return;  // Bail to calling function upon system abort
+                }
 #ifdef REPORT_ECHO_RAW_LINE_RECEIVED
-                        report_echo_line_received(line, client);
+                report_echo_line_received(line, client);
 #endif
-                        // auth_level can be upgraded by supplying a password on the command line
-                        report_status_message(execute_line(line, client, WebUI::AuthenticationLevel::LEVEL_GUEST), client);
-                        empty_line(client);
-                        break;
-                    case Error::Overflow:
-                        report_status_message(Error::Overflow, client);
-                        empty_line(client);
-                        break;
-                    default:
-                        break;
+                if (line[0] == '@' && client_streams[client].enabled) {
+                    stream_execute_line(line, client);
+                    continue;
                 }
-            }  // while serial read
+                // auth_level can be upgraded by supplying a password on the command line
+                report_status_message(execute_line(line, client, WebUI::AuthenticationLevel::LEVEL_GUEST), client);
+            }  // while lines
         }  // for clients
+        stream_poll_acks();
         // If there are no more characters in the serial read buffer to be processed and executed,
         // this indicates that g-code streaming has either filled the planner buffer or has
         // completed. In either case, auto-cycle start, if enabled, any queued moves.
@@ -191,6 +230,7 @@ void protocol_main_loop() {
         if (sys.abort) {
             return;  // Bail to main() program loop to reset system.
         }
+        nvs_cache_poll();
         // check to see if we should disable the stepper drivers ... esp32 work around for disable in main loop.
         if (stepper_idle && stepper_idle_lock_time->get() != 0xff) {
             if (esp_timer_get_time() > stepper_idle_counter) {
@@ -212,6 +252,7 @@ void protocol_buffer_synchronize() {
             return;  // Check for system abort
         }
     } while (plan_get_current_block() || (sys.state == State::Cycle));
+    nvs_cache_poll();  // Motion has stopped, so this is a safe time for pending NVS writes
 }
 
 // Auto-cycle start triggers when there is a motion ready to execute and if the main program is not
@@ -274,6 +315,7 @@ void protocol_exec_rt_system() {
     if (rt_exec_state.value != 0 || cycle_stop) {   // Test if any bits are on
         // Execute system abort.
         if (rt_exec_state.bit.reset) {
+            rt_trace_stage(RtEvent::Reset, RtStage::Pickup);
             sys.abort = true;  // Only place this is set true.
             return;            // Nothing else to do but exit.
         }
@@ -318,6 +360,10 @@ void protocol_exec_rt_system() {
                 }
                 // Execute a feed hold with deceleration, if required. Then, suspend system.
                 if (rt_exec_state.bit.feedHold) {
+                    rt_trace_stage(RtEvent::FeedHold, RtStage::Pickup);
+                    if (sys.state != State::Cycle && sys.state != State::Jog) {
+                        rt_trace_end(RtEvent::FeedHold);  // Nothing to decelerate
+                    }
                     // Block SAFETY_DOOR, JOG, and SLEEP states from changing to HOLD state.
                     if (!(sys.state == State::SafetyDoor || sys.state == State::Jog || sys.state == State::Sleep)) {
                         sys.state = State::Hold;
@@ -453,17 +499,23 @@ void protocol_exec_rt_system() {
         sys.report_ovr_counter = 0;  // Set to report change immediately
         plan_update_velocity_profile_parameters();
         plan_cycle_reinitialize();
+        rt_trace_stage(RtEvent::Override, RtStage::Pickup);
     }
 
-    // NOTE: Unlike motion overrides, spindle overrides do not require a planner reinitialization.
+    // NOTE: Spindle overrides only replan for the G95 feeds, which follow the spindle speed.
     if (sys_rt_s_override != sys.spindle_speed_ovr) {
         sys.step_control.updateSpindleRpm = true;
         sys.spindle_speed_ovr             = sys_rt_s_override;
         sys.report_ovr_counter            = 0;  // Set to report change immediately
+        if (plan_has_feed_per_rev_block()) {
+            plan_update_velocity_profile_parameters();
+            plan_cycle_reinitialize();
+        }
         // If spinlde is on, tell it the rpm has been overridden
         if (gc_state.modal.spindle != SpindleState::Disable) {
             spindle->set_rpm(gc_state.spindle_speed);
         }
+        rt_trace_stage(RtEvent::Override, RtStage::Pickup);
     }
 
     if (sys_rt_exec_accessory_override.bit.spindleOvrStop) {
@@ -45,6 +45,10 @@ void protocol_exec_rt_system();
 // Executes the auto cycle feature, if enabled.
 void protocol_auto_cycle_start();
 
+// Turns batched acknowledgement streaming on or off for a client
+Error protocol_set_stream_mode(uint8_t client, bool enable);
+bool  protocol_get_stream_mode(uint8_t client);
+
 // Block until all buffered steps are executed
 void protocol_buffer_synchronize();
 
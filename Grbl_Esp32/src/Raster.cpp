@@ -0,0 +1,97 @@
+/*
+  Raster.cpp - Laser raster lines with packed pixels
+  Part of Grbl_ESP32
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Grbl.h"
+
+#include <mbedtls/base64.h>
+
+const int RASTER_N_NUMBERS = 5;  // x, y, dx, dy, feed
+
+static RasterLine raster_line;  // Decoded here, then copied into the planner block
+
+Error raster_execute(const char* value) {
+    if (sys.state == State::Alarm || sys.state == State::Jog) {
+        return Error::SystemGcLock;
+    }
+    if (!spindle->inLaserMode()) {
+        return Error::RasterNotLaser;
+    }
+    if (value == NULL) {
+        return Error::RasterInvalid;
+    }
+
+    float number[RASTER_N_NUMBERS];
+    for (int i = 0; i < RASTER_N_NUMBERS; i++) {
+        char* end;
+        number[i] = strtof(value, &end);
+        if (end == value || *end != ',') {
+            return Error::RasterInvalid;
+        }
+        value = end + 1;
+    }
+    size_t n_pixels;
+    if (mbedtls_base64_decode(raster_line.pixels, RASTER_MAX_PIXELS, &n_pixels, (const unsigned char*)value, strlen(value)) != 0 ||
+        n_pixels == 0) {
+        return Error::RasterInvalid;
+    }
+    raster_line.n_pixels = n_pixels;
+
+    if (gc_state.modal.units == Units::Inches) {
+        for (int i = 0; i < RASTER_N_NUMBERS; i++) {
+            number[i] *= MM_PER_INCH;
+        }
+    }
+    float feed_rate = number[4];
+    if (feed_rate <= 0.0) {
+        return Error::RasterInvalid;
+    }
+
+    float start[MAX_N_AXIS], target[MAX_N_AXIS];
+    memcpy(start, gc_state.position, sizeof(start));
+    for (int axis = X_AXIS; axis <= Y_AXIS; axis++) {
+        start[axis] = number[axis] + gc_state.coord_system[axis] + gc_state.coord_offset[axis] + gc_state.tool_length_offset[axis];
+    }
+    memcpy(target, start, sizeof(target));
+    target[X_AXIS] += number[2] * n_pixels;
+    target[Y_AXIS] += number[3] * n_pixels;
+    if (soft_limits->get() && (limitsCheckTravel(start) || limitsCheckTravel(target))) {
+        return Error::TravelExceeded;
+    }
+
+    plan_line_data_t  plan_data;
+    plan_line_data_t* pl_data = &plan_data;
+    if (memcmp(start, gc_state.position, sizeof(start)) != 0) {
+        // Lasers are off during rapids
+        memset(pl_data, 0, sizeof(plan_line_data_t));
+        pl_data->motion.rapidMotion = 1;
+        pl_data->spindle            = gc_state.modal.spindle;
+        pl_data->coolant            = gc_state.modal.coolant;
+        mc_line(start, pl_data);
+        memcpy(gc_state.position, start, sizeof(start));
+    }
+
+    memset(pl_data, 0, sizeof(plan_line_data_t));
+    pl_data->feed_rate     = feed_rate;
+    pl_data->spindle       = gc_state.modal.spindle;
+    pl_data->spindle_speed = gc_state.spindle_speed;
+    pl_data->coolant       = gc_state.modal.coolant;
+    pl_data->raster        = &raster_line;
+    mc_line(target, pl_data);
+    memcpy(gc_state.position, target, sizeof(target));
+    return Error::Ok;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+/*
+  Raster.h - Laser raster lines with packed pixels
+  Part of Grbl_ESP32
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Config.h"
+#include "Error.h"
+
+#include <cstdint>
+
+// A raster line is one planner block. The step ISR sets the laser power of
+// each pixel as the laser crosses into it, so an engraving runs at the feed
+// rate instead of at the rate the parser can plan one G1 per pixel.
+//
+//   $Raster=x,y,dx,dy,feed,pixels
+//
+// x,y is the start in work coordinates, in the current units and always
+// absolute. dx,dy is the distance from one pixel to the next, which gives the
+// direction and the pitch. pixels is base64, one byte per pixel, where 255 is
+// the current S value. If the laser is not at the start, it moves there at
+// the rapid rate with the laser off. The modal state is not changed.
+struct RasterLine {
+    uint16_t n_pixels;
+    uint8_t  pixels[RASTER_MAX_PIXELS];
+};
+
+Error raster_execute(const char* value);
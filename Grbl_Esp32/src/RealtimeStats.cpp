@@ -0,0 +1,150 @@
+/*
+  RealtimeStats.cpp - Latency tracing for realtime commands
+  Part of Grbl_ESP32
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+
+  Each traced command keeps the time it was read and the client it came from
+  until its last stage is recorded. A newer command of the same kind replaces
+  it. A hold issued while nothing moves never decelerates, so it ends when it
+  is picked up; a later hold from a pin or the door is not timed against it.
+  Stages are recorded by different tasks, but each stage only by one of them,
+  so the counters need no locking.
+*/
+
+#include "RealtimeStats.h"
+#include "ReportWriter.h"
+
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t total_us;
+    uint32_t buckets[RT_STATS_BUCKETS];
+} rt_histogram_t;
+
+typedef struct {
+    volatile bool active;
+    uint8_t       client;
+    uint32_t      rx_us;
+} rt_pending_t;
+
+static const int RT_EVENTS = static_cast<int>(RtEvent::Count);
+static const int RT_STAGES = static_cast<int>(RtStage::Count);
+
+static rt_histogram_t rt_stats[RT_EVENTS][CLIENT_COUNT][RT_STAGES];
+static rt_pending_t   rt_pending[RT_EVENTS];
+
+static const char* rt_event_names[RT_EVENTS] = { "FeedHold", "Reset", "Override" };
+static const char* rt_stage_names[RT_STAGES] = { "Flag", "Pickup", "Effect" };
+static const char* rt_client_names[]         = { "Serial", "BT", "WebUI", "Telnet", "Input" };
+
+// The stage after which a command is complete
+static RtStage rt_last_stage(RtEvent event) {
+    return event == RtEvent::FeedHold ? RtStage::Effect : RtStage::Pickup;
+}
+
+void rt_trace_rx(Cmd command, uint8_t client) {
+    RtEvent event;
+    if (command == Cmd::FeedHold) {
+        event = RtEvent::FeedHold;
+    } else if (command == Cmd::Reset) {
+        event = RtEvent::Reset;
+    } else if (command >= Cmd::FeedOvrReset && command <= Cmd::SpindleOvrFineMinus) {
+        event = RtEvent::Override;
+    } else {
+        return;
+    }
+    if (client >= CLIENT_COUNT) {
+        return;
+    }
+    rt_pending_t* pending = &rt_pending[static_cast<int>(event)];
+    pending->active       = false;
+    pending->client       = client;
+    pending->rx_us        = esp_timer_get_time();
+    pending->active       = true;
+}
+
+void rt_trace_stage(RtEvent event, RtStage stage) {
+    rt_pending_t* pending = &rt_pending[static_cast<int>(event)];
+    if (!pending->active) {
+        return;
+    }
+    uint32_t        elapsed = uint32_t(esp_timer_get_time()) - pending->rx_us;
+    rt_histogram_t* h       = &rt_stats[static_cast<int>(event)][pending->client][static_cast<int>(stage)];
+    int             bucket  = 0;
+    while (bucket < RT_STATS_BUCKETS - 1 && elapsed >= (uint32_t(RT_STATS_FIRST_BUCKET_US) << bucket)) {
+        bucket++;
+    }
+    h->buckets[bucket]++;
+    h->total_us += elapsed;
+    h->max_us = MAX(h->max_us, elapsed);
+    h->count++;
+    if (stage == rt_last_stage(event)) {
+        pending->active = false;
+    }
+}
+
+void rt_trace_end(RtEvent event) {
+    rt_pending[static_cast<int>(event)].active = false;
+}
+
+void rt_stats_report(uint8_t client) {
+    char         line[160];
+    ReportWriter header(line, sizeof(line), 3);
+    header.add_label("[RT:Buckets(us)");
+    for (int bucket = 0; bucket < RT_STATS_BUCKETS - 1; bucket++) {
+        header.add_label(",<");
+        header.add_uint(RT_STATS_FIRST_BUCKET_US << bucket);
+    }
+    header.add_label(",>=");
+    header.add_uint(RT_STATS_FIRST_BUCKET_US << (RT_STATS_BUCKETS - 2));
+    header.finish("]\r\n");
+    grbl_send(client, line);
+    for (int event = 0; event < RT_EVENTS; event++) {
+        for (int client_num = 0; client_num < CLIENT_COUNT; client_num++) {
+            for (int stage = 0; stage < RT_STAGES; stage++) {
+                rt_histogram_t* h = &rt_stats[event][client_num][stage];
+                if (h->count == 0) {
+                    continue;
+                }
+                ReportWriter rw(line, sizeof(line), 3);
+                rw.add_label("[RT:");
+                rw.add(rt_event_names[event]);
+                rw.add(',');
+                rw.add(rt_client_names[client_num]);
+                rw.add(',');
+                rw.add(rt_stage_names[stage]);
+                rw.add_label(",N:");
+                rw.add_uint(h->count);
+                rw.add_label(",Avg:");
+                rw.add_uint(uint32_t(h->total_us / h->count));
+                rw.add_label(",Max:");
+                rw.add_uint(h->max_us);
+                rw.add_label(",Hist:");
+                for (int bucket = 0; bucket < RT_STATS_BUCKETS; bucket++) {
+                    if (bucket) {
+                        rw.add(',');
+                    }
+                    rw.add_uint(h->buckets[bucket]);
+                }
+                rw.finish("]\r\n");
+                grbl_send(client, line);
+            }
+        }
+    }
+}
+
+void rt_stats_clear() {
+    memset(rt_stats, 0, sizeof(rt_stats));
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+/*
+  RealtimeStats.h - Latency tracing for realtime commands
+  Part of Grbl_ESP32
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Grbl.h"
+
+// Realtime commands that are traced from the moment the client task reads them
+enum class RtEvent : uint8_t {
+    FeedHold = 0,
+    Reset,
+    Override,  // feed, rapid and spindle overrides
+    Count,
+};
+
+// Points along the way, each measured from when the command was read
+enum class RtStage : uint8_t {
+    Flag = 0,  // execute_realtime_command() set the flag, or for reset, stopped motion
+    Pickup,    // the protocol loop acted on the flag
+    Effect,    // feed hold only: the first decelerating segment was prepared
+    Count,
+};
+
+// Histogram buckets double from RT_STATS_FIRST_BUCKET_US; the last one has no upper bound
+const int RT_STATS_BUCKETS         = 12;
+const int RT_STATS_FIRST_BUCKET_US = 32;
+
+// Called by the client task when it reads a realtime command
+void rt_trace_rx(Cmd command, uint8_t client);
+
+// Records a later stage of the command that is in flight, if any
+void rt_trace_stage(RtEvent event, RtStage stage);
+
+// Forgets the command in flight, for when its later stages will not happen
+void rt_trace_end(RtEvent event);
+
+void rt_stats_report(uint8_t client);
+void rt_stats_clear();
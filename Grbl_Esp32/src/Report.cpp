@@ -47,6 +47,7 @@
 */
 
 #include "Grbl.h"
+#include "ReportWriter.h"
 #include <map>
 
 #ifdef REPORT_HEAP
@@ -58,31 +59,57 @@ void grbl_send(uint8_t client, const char* text) {
     client_write(client, text);
 }
 
+// Formatted output is built once in a stack buffer and client_write() copies it into the
+// client's TX ring. Anything longer than MESSAGE_BUFFER_SIZE is formatted again into a heap
+// buffer of the right size. Only if that allocation fails is it truncated, keeping the line
+// ending so the host stays in sync.
+static const int MESSAGE_BUFFER_SIZE = LINE_BUFFER_SIZE + 64;
+
+static void grbl_vsendf(uint8_t client, const char* prefix, const char* format, va_list arg, const char* suffix) {
+    char    buf[MESSAGE_BUFFER_SIZE];
+    size_t  prefix_len = strlen(prefix);
+    size_t  suffix_len = strlen(suffix);
+    size_t  room       = sizeof(buf) - prefix_len - suffix_len;
+    va_list copy;
+    va_copy(copy, arg);
+    memcpy(buf, prefix, prefix_len);
+    int len = vsnprintf(buf + prefix_len, room, format, arg);
+    if (len < 0) {
+        va_end(copy);
+        return;
+    }
+    if (size_t(len) >= room) {
+        char* big = new char[prefix_len + len + suffix_len + 1];
+        if (big != NULL) {
+            memcpy(big, prefix, prefix_len);
+            vsnprintf(big + prefix_len, len + 1, format, copy);
+            memcpy(big + prefix_len + len, suffix, suffix_len + 1);
+            va_end(copy);
+            client_write(client, big);
+            delete[] big;
+            return;
+        }
+        len               = room - 1;
+        size_t format_len = strlen(format);
+        if (format_len >= 2 && format[format_len - 1] == '\n') {
+            buf[prefix_len + len - 2] = '\r';
+            buf[prefix_len + len - 1] = '\n';
+        }
+    }
+    va_end(copy);
+    memcpy(buf + prefix_len + len, suffix, suffix_len + 1);
+    client_write(client, buf);
+}
+
 // This is a formating version of the grbl_send(CLIENT_ALL,...) function that work like printf
 void grbl_sendf(uint8_t client, const char* format, ...) {
     if (client == CLIENT_INPUT) {
         return;
     }
-    char    loc_buf[64];
-    char*   temp = loc_buf;
     va_list arg;
-    va_list copy;
     va_start(arg, format);
-    va_copy(copy, arg);
-    size_t len = vsnprintf(NULL, 0, format, arg);
-    va_end(copy);
-    if (len >= sizeof(loc_buf)) {
-        temp = new char[len + 1];
-        if (temp == NULL) {
-            return;
-        }
-    }
-    len = vsnprintf(temp, len + 1, format, arg);
-    grbl_send(client, temp);
+    grbl_vsendf(client, "", format, arg, "");
     va_end(arg);
-    if (temp != loc_buf) {
-        delete[] temp;
-    }
 }
 // Use to send [MSG:xxxx] Type messages. The level allows messages to be easily suppressed
 void grbl_msg_sendf(uint8_t client, MsgLevel level, const char* format, ...) {
@@ -96,26 +123,10 @@ void grbl_msg_sendf(uint8_t client, MsgLevel level, const char* format, ...) {
         }
     }
 
-    char    loc_buf[100];
-    char*   temp = loc_buf;
     va_list arg;
-    va_list copy;
     va_start(arg, format);
-    va_copy(copy, arg);
-    size_t len = vsnprintf(NULL, 0, format, arg);
-    va_end(copy);
-    if (len >= sizeof(loc_buf)) {
-        temp = new char[len + 1];
-        if (temp == NULL) {
-            return;
-        }
-    }
-    len = vsnprintf(temp, len + 1, format, arg);
-    grbl_sendf(client, "[MSG:%s]\r\n", temp);
+    grbl_vsendf(client, "[MSG:", format, arg, "]\r\n");
     va_end(arg);
-    if (temp != loc_buf) {
-        delete[] temp;
-    }
 }
 
 //function to notify
@@ -126,80 +137,55 @@ void grbl_notify(const char* title, const char* msg) {
 }
 
 void grbl_notifyf(const char* title, const char* format, ...) {
-    char    loc_buf[64];
-    char*   temp = loc_buf;
+    char    buf[MESSAGE_BUFFER_SIZE];
     va_list arg;
-    va_list copy;
     va_start(arg, format);
-    va_copy(copy, arg);
-    size_t len = vsnprintf(NULL, 0, format, arg);
-    va_end(copy);
-    if (len >= sizeof(loc_buf)) {
-        temp = new char[len + 1];
-        if (temp == NULL) {
-            return;
-        }
-    }
-    len = vsnprintf(temp, len + 1, format, arg);
-    grbl_notify(title, temp);
+    vsnprintf(buf, sizeof(buf), format, arg);
     va_end(arg);
-    if (temp != loc_buf) {
-        delete[] temp;
-    }
+    grbl_notify(title, buf);
 }
 
 static const int coordStringLen = 20;
 static const int axesStringLen  = coordStringLen * MAX_N_AXIS;
 
-// formats axis values into a string and returns that string in rpt
-// NOTE: rpt should have at least size: axesStringLen
-static void report_util_axis_values(float* axis_value, char* rpt) {
-    uint8_t     idx;
-    char        axisVal[coordStringLen];
-    float       unit_conv = 1.0;      // unit conversion multiplier..default is mm
-    float       rpm_conv  = 1.0;      // unit conversion multiplier..default is mm
-    const char* format    = "%4.3f";  // Default - report mm to 3 decimal places
-    rpt[0]                = '\0';
+// Formats value with a fixed number of decimals without printf.
+// buf must hold coordStringLen characters. Returns a pointer to the terminating '\0'.
+char* report_util_fixed(char* buf, float value, int decimals) {
+    ReportWriter rw(buf, coordStringLen);
+    rw.add_fixed(value, decimals);
+    return buf + rw.length();
+}
+
+// Adds comma separated axis values in the report units
+static void report_util_axis_values(ReportWriter& rw, const float* axis_value, bool convert_rpm = true) {
+    float unit_conv = 1.0;  // unit conversion multiplier..default is mm
+    float rpm_conv  = 1.0;  // unit conversion multiplier..default is mm
+    int   decimals  = 3;    // Default - report mm to 3 decimal places
     if (report_inches->get()) {
         unit_conv = 1.0 / MM_PER_INCH;
-        format    = "%4.4f";  // Report inches to 4 decimal places
+        decimals  = 4;  // Report inches to 4 decimal places
     }
     auto n_axis = number_axis->get();
-    for (idx = 0; idx < n_axis; idx++) {
+    for (uint8_t idx = 0; idx < n_axis; idx++) {
 #ifdef POSITIONABLE_AXIS_CONVERT
-        if (isAxisRpm(idx)) {
+        if (convert_rpm && isAxisRpm(idx)) {
             rpm_conv = axis_convet_multiplier->get();
         } else {
             rpm_conv = 1.0;
         }
 #endif
-        snprintf(axisVal, coordStringLen - 1, format, axis_value[idx] * unit_conv * rpm_conv);
-        strcat(rpt, axisVal);
-        if (idx < (number_axis->get() - 1)) {
-            strcat(rpt, ",");
+        if (idx) {
+            rw.add(',');
         }
+        rw.add_fixed(axis_value[idx] * unit_conv * rpm_conv, decimals);
     }
 }
 
-// This version returns the axis values as a String
-static String report_util_axis_values(const float* axis_value) {
-    String  rpt = "";
-    uint8_t idx;
-    char    axisVal[coordStringLen];
-    float   unit_conv = 1.0;  // unit conversion multiplier..default is mm
-    int     decimals  = 3;    // Default - report mm to 3 decimal places
-    if (report_inches->get()) {
-        unit_conv = 1.0 / MM_PER_INCH;
-        decimals  = 4;  // Report inches to 4 decimal places
-    }
-    auto n_axis = number_axis->get();
-    for (idx = 0; idx < n_axis; idx++) {
-        rpt += String(axis_value[idx] * unit_conv, decimals);
-        if (idx < (number_axis->get() - 1)) {
-            rpt += ",";
-        }
-    }
-    return rpt;
+// formats axis values into a string and returns that string in rpt
+// NOTE: rpt should have at least size: axesStringLen
+static void report_util_axis_values(const float* axis_value, char* rpt, bool convert_rpm = true) {
+    ReportWriter rw(rpt, axesStringLen);
+    report_util_axis_values(rw, axis_value, convert_rpm);
 }
 
 // Handles the primary confirmation protocol response for streaming interfaces and human-feedback.
@@ -324,44 +310,31 @@ void report_probe_parameters(uint8_t client) {
 
 // Prints Grbl NGC parameters (coordinate offsets, probing)
 void report_ngc_parameters(uint8_t client) {
-    String ngc_rpt = "";
-    float  temp[MAX_N_AXIS];
+    char  rpt[axesStringLen];
+    float temp[MAX_N_AXIS];
 
     // Print persistent offsets G54 - G59, G28, and G30
     for (auto coord_select = CoordIndex::Begin; coord_select < CoordIndex::End; ++coord_select) {
-        ngc_rpt += "[";
-        ngc_rpt += coords[coord_select]->getName();
-        ngc_rpt += ":";
-        ngc_rpt += report_util_axis_values(coords[coord_select]->get());
-        ngc_rpt += "]\r\n";
-    }
-    ngc_rpt += "[G92:";  // Print non-persistent G92,G92.1
-    ngc_rpt += report_util_axis_values(gc_state.coord_offset);
-    ngc_rpt += "]\r\n";
-    ngc_rpt += "[TLO:";  // Print tool length offset
-    ngc_rpt += report_util_axis_values(gc_state.tool_length_offset);
-    ngc_rpt += "]\r\n";
+        report_util_axis_values(coords[coord_select]->get(), rpt, false);
+        grbl_sendf(client, "[%s:%s]\r\n", coords[coord_select]->getName(), rpt);
+    }
+    report_util_axis_values(gc_state.coord_offset, rpt, false);
+    grbl_sendf(client, "[G92:%s]\r\n", rpt);  // Print non-persistent G92,G92.1
+    report_util_axis_values(gc_state.tool_length_offset, rpt, false);
+    grbl_sendf(client, "[TLO:%s]\r\n", rpt);  // Print tool length offset
 
     // tool table
     for (int idx = 0; idx < tool_count->get(); idx++) {  // Axes indices are consistent, so loop may be used.
-        ngc_rpt += "[T";
-        ngc_rpt += idx + 1;
-        ngc_rpt += ":";
+        char p[coordStringLen], r[coordStringLen], i[coordStringLen], j[coordStringLen], q[coordStringLen];
         ToolTable->get_xyz(temp, idx);
-        ngc_rpt += report_util_axis_values(temp);
-        ngc_rpt += ", p:";
-        ngc_rpt += ToolTable->get_p(idx);
-        ngc_rpt += ", r:";
-        ngc_rpt += ToolTable->get_r(idx);
-        ngc_rpt += ", i:";
-        ngc_rpt += ToolTable->get_i(idx);
-        ngc_rpt += ", j:";
-        ngc_rpt += ToolTable->get_j(idx);
-        ngc_rpt += ", q:";
-        ngc_rpt += ToolTable->get_q(idx);
-        ngc_rpt += "]\r\n";
-    }
-    grbl_send(client, ngc_rpt.c_str());
+        report_util_axis_values(temp, rpt, false);
+        report_util_fixed(p, ToolTable->get_p(idx), 2);
+        report_util_fixed(r, ToolTable->get_r(idx), 2);
+        report_util_fixed(i, ToolTable->get_i(idx), 2);
+        report_util_fixed(j, ToolTable->get_j(idx), 2);
+        report_util_fixed(q, ToolTable->get_q(idx), 2);
+        grbl_sendf(client, "[T%d:%s, p:%s, r:%s, i:%s, j:%s, q:%s]\r\n", idx + 1, rpt, p, r, i, j, q);
+    }
     report_probe_parameters(client);
 }
 
@@ -471,6 +444,19 @@ void report_gcode_modes(uint8_t client) {
         case FeedRate::InverseTime:
             mode = " G93";
             break;
+        case FeedRate::UnitsPerRev:
+            mode = " G95";
+            break;
+    }
+    strcat(modes_rpt, mode);
+
+    switch (gc_state.modal.spindle_speed_mode) {
+        case SpindleSpeedMode::Rpm:
+            mode = " G97";
+            break;
+        case SpindleSpeedMode::SurfaceSpeed:
+            mode = " G96";
+            break;
     }
     strcat(modes_rpt, mode);
 
@@ -533,7 +519,13 @@ void report_gcode_modes(uint8_t client) {
     strcat(modes_rpt, temp);
     sprintf(temp, report_inches->get() ? " F%.1f" : " F%.0f", gc_state.feed_rate);
     strcat(modes_rpt, temp);
-    sprintf(temp, " S%d", uint32_t(gc_state.spindle_speed));
+    if (gc_state.modal.spindle_speed_mode == SpindleSpeedMode::SurfaceSpeed) {
+        // The surface speed in m/min or ft/min, as programmed
+        float surface_speed = gc_state.surface_speed / ((gc_state.modal.units == Units::Inches) ? MM_PER_INCH * 12 : 1000);
+        sprintf(temp, " S%d", uint32_t(surface_speed));
+    } else {
+        sprintf(temp, " S%d", uint32_t(gc_state.spindle_speed));
+    }
     strcat(modes_rpt, temp);
     strcat(modes_rpt, "]\r\n");
     // grbl_send(client, modes_rpt);
@@ -625,45 +617,53 @@ void report_echo_line_received(char* line, uint8_t client) {
 // specific needs, but the desired real-time data report must be as short as possible. This is
 // requires as it minimizes the computational overhead and allows grbl to keep running smoothly,
 // especially during g-code programs with fast, short line segments and high frequency reports (5-20Hz).
-void report_realtime_status(uint8_t client) {
-    char status[200];
-    char temp[MAX_N_AXIS * 20];
+//
+// The report is built in two steps so it can be shared. report_build_status() builds everything except
+// the client specific |Bf: field and returns where that belongs, and report_send_status() adds it for
+// each client the report goes to.
+static const int STATUS_BF_FIELD_SIZE = 20;  // "|Bf:" with two numbers
+
+static int report_rx_buffer_available(uint8_t client) {
+    int bufsize = DEFAULTBUFFERSIZE;
+#if defined(ENABLE_WIFI) && defined(ENABLE_TELNET)
+    if (client == CLIENT_TELNET) {
+        bufsize = WebUI::telnet_server.get_rx_buffer_available();
+    }
+#endif  //ENABLE_WIFI && ENABLE_TELNET
+#if defined(ENABLE_BLUETOOTH)
+    if (client == CLIENT_BT) {
+        //TODO FIXME
+        bufsize = 512 - WebUI::SerialBT.available();
+    }
+#endif  //ENABLE_BLUETOOTH
+    if (client == CLIENT_SERIAL) {
+        bufsize = client_get_rx_buffer_available(CLIENT_SERIAL);
+    }
+    return bufsize;
+}
 
-    strcpy(status, "<");
-    strcat(status, report_state_text());
+static size_t report_build_status(char* status, size_t size) {
+    ReportWriter rw(status, size, 3);  // room for ">\r\n"
+    size_t       bf_at;
+
+    rw.add('<');
+    rw.add(report_state_text());
 
     // Report position
     float* print_position = system_get_mpos();
+    float* wco            = get_wco();  // Shared by WPos and WCO
     if (bit_istrue(status_mask->get(), RtStatus::Position)) {
-        strcat(status, "|MPos:");
+        rw.add_label("|MPos:");
     } else {
-        strcat(status, "|WPos:");
-        mpos_to_wpos(print_position);
-    }
-    report_util_axis_values(print_position, temp);
-    strcat(status, temp);
-    // Returns planner and serial read buffer states.
-#ifdef REPORT_FIELD_BUFFER_STATE
-    if (bit_istrue(status_mask->get(), RtStatus::Buffer)) {
-        int bufsize = DEFAULTBUFFERSIZE;
-#    if defined(ENABLE_WIFI) && defined(ENABLE_TELNET)
-        if (client == CLIENT_TELNET) {
-            bufsize = WebUI::telnet_server.get_rx_buffer_available();
+        rw.add_label("|WPos:");
+        auto n_axis = number_axis->get();
+        for (int idx = 0; idx < n_axis; idx++) {
+            print_position[idx] -= wco[idx];
         }
-#    endif  //ENABLE_WIFI && ENABLE_TELNET
-#    if defined(ENABLE_BLUETOOTH)
-        if (client == CLIENT_BT) {
-            //TODO FIXME
-            bufsize = 512 - WebUI::SerialBT.available();
-        }
-#    endif  //ENABLE_BLUETOOTH
-        if (client == CLIENT_SERIAL) {
-            bufsize = client_get_rx_buffer_available(CLIENT_SERIAL);
-        }
-        sprintf(temp, "|Bf:%d,%d", plan_get_block_buffer_available(), bufsize);
-        strcat(status, temp);
     }
-#endif
+    report_util_axis_values(rw, print_position);
+    // Planner and serial read buffer states are added per client by report_send_status()
+    bf_at = rw.length();
 #ifdef USE_LINE_NUMBERS
 #    ifdef REPORT_FIELD_LINE_NUMBERS
     // Report current line number
@@ -671,83 +671,70 @@ void report_realtime_status(uint8_t client) {
     if (cur_block != NULL) {
         uint32_t ln = cur_block->line_number;
         if (ln > 0) {
-            sprintf(temp, "|Ln:%d", ln);
-            strcat(status, temp);
+            rw.add_label("|Ln:");
+            rw.add_uint(ln);
         }
     }
 #    endif
 #endif
     // Report realtime feed speed
 #ifdef REPORT_FIELD_CURRENT_FEED_SPEED
+    rw.add_label("|FS:");
     if (report_inches->get()) {
-        sprintf(temp, "|FS:%.1f,%d", st_get_realtime_rate() / MM_PER_INCH, sys.spindle_speed);
+        rw.add_fixed(st_get_realtime_rate() / MM_PER_INCH, 1);
     } else {
-        sprintf(temp, "|FS:%.0f,%d", st_get_realtime_rate(), sys.spindle_speed);
+        rw.add_fixed(st_get_realtime_rate(), 0);
     }
-    strcat(status, temp);
+    rw.add(',');
+    rw.add_uint(sys.spindle_speed);
 #endif
-    // sprintf(temp, "|Led:%s", led_state->getStringValue());
-    // strcat(status, temp);
-    strcat(status, "|R:");
+    rw.add_label("|R:");
     if (led_state->get())
-        strcat(status, "L");
+        rw.add('L');
     if (atc_connected->get())
-        strcat(status, "A");
+        rw.add('A');
 
 #ifdef REPORT_FIELD_PIN_STATE
     AxisMask    lim_pin_state  = limits_get_state();
     ControlPins ctrl_pin_state = system_control_get_state();
     bool        prb_pin_state  = probe_get_state();
     if (lim_pin_state || ctrl_pin_state.value || prb_pin_state) {
-        strcat(status, "|Pn:");
+        rw.add_label("|Pn:");
         if (prb_pin_state) {
-            strcat(status, "P");
+            rw.add('P');
         }
         if (lim_pin_state) {
             auto n_axis = number_axis->get();
-            if (n_axis >= 1 && bit_istrue(lim_pin_state, bit(X_AXIS))) {
-                strcat(status, "X");
-            }
-            if (n_axis >= 2 && bit_istrue(lim_pin_state, bit(Y_AXIS))) {
-                strcat(status, "Y");
-            }
-            if (n_axis >= 3 && bit_istrue(lim_pin_state, bit(Z_AXIS))) {
-                strcat(status, "Z");
-            }
-            if (n_axis >= 4 && bit_istrue(lim_pin_state, bit(A_AXIS))) {
-                strcat(status, "A");
-            }
-            if (n_axis >= 5 && bit_istrue(lim_pin_state, bit(B_AXIS))) {
-                strcat(status, "B");
-            }
-            if (n_axis >= 6 && bit_istrue(lim_pin_state, bit(C_AXIS))) {
-                strcat(status, "C");
+            for (int axis = 0; axis < n_axis; axis++) {
+                if (bit_istrue(lim_pin_state, bit(axis))) {
+                    rw.add("XYZABC"[axis]);
+                }
             }
         }
         if (ctrl_pin_state.value) {
             if (ctrl_pin_state.bit.safetyDoor) {
-                strcat(status, "D");
+                rw.add('D');
             }
             if (ctrl_pin_state.bit.reset) {
-                strcat(status, "R");
+                rw.add('R');
             }
             if (ctrl_pin_state.bit.feedHold) {
-                strcat(status, "H");
+                rw.add('H');
             }
             if (ctrl_pin_state.bit.cycleStart) {
-                strcat(status, "S");
+                rw.add('S');
             }
             if (ctrl_pin_state.bit.macro0) {
-                strcat(status, "0");
+                rw.add('0');
             }
             if (ctrl_pin_state.bit.macro1) {
-                strcat(status, "1");
+                rw.add('1');
             }
             if (ctrl_pin_state.bit.macro2) {
-                strcat(status, "2");
+                rw.add('2');
             }
             if (ctrl_pin_state.bit.macro3) {
-                strcat(status, "3");
+                rw.add('3');
             }
         }
     }
@@ -770,9 +757,8 @@ void report_realtime_status(uint8_t client) {
         if (sys.report_ovr_counter == 0) {
             sys.report_ovr_counter = 1;  // Set override on next report.
         }
-        strcat(status, "|WCO:");
-        report_util_axis_values(get_wco(), temp);
-        strcat(status, temp);
+        rw.add_label("|WCO:");
+        report_util_axis_values(rw, wco);
     }
 #endif
 #ifdef REPORT_FIELD_OVERRIDES
@@ -791,30 +777,34 @@ void report_realtime_status(uint8_t client) {
                 break;
         }
 
-        sprintf(temp, "|Ov:%d,%d,%d", sys.f_override, sys.r_override, sys.spindle_speed_ovr);
-        strcat(status, temp);
+        rw.add_label("|Ov:");
+        rw.add_uint(sys.f_override);
+        rw.add(',');
+        rw.add_uint(sys.r_override);
+        rw.add(',');
+        rw.add_uint(sys.spindle_speed_ovr);
         SpindleState sp_state      = spindle->get_state();
         CoolantState coolant_state = coolant_get_state();
         if (sp_state != SpindleState::Disable || coolant_state.Mist || coolant_state.Flood) {
-            strcat(status, "|A:");
+            rw.add_label("|A:");
             switch (sp_state) {
                 case SpindleState::Disable:
                     break;
                 case SpindleState::Cw:
-                    strcat(status, "S");
+                    rw.add('S');
                     break;
                 case SpindleState::Ccw:
-                    strcat(status, "C");
+                    rw.add('C');
                     break;
             }
 
             auto coolant = coolant_state;
             if (coolant.Flood) {
-                strcat(status, "F");
+                rw.add('F');
             }
 #    ifdef COOLANT_MIST_PIN  // TODO Deal with M8 - Flood
             if (coolant.Mist) {
-                strcat(status, "M");
+                rw.add('M');
             }
 #    endif
         }
@@ -822,18 +812,163 @@ void report_realtime_status(uint8_t client) {
 #endif
 #ifdef ENABLE_SD_CARD
     if (get_sd_state(false) == SDState::BusyPrinting) {
-        sprintf(temp, "|SD:%4.2f,", sd_report_perc_complete());
-        strcat(status, temp);
-        sd_get_current_filename(temp);
-        strcat(status, temp);
+        rw.add_label("|SD:");
+        rw.add_fixed(sd_report_perc_complete(), 2);
+        rw.add(',');
+        rw.add(sd_current_filename());  // Cut short if the report is full
     }
 #endif
 #ifdef REPORT_HEAP
-    sprintf(temp, "|Heap:%d", esp.getHeapSize());
-    strcat(status, temp);
+    rw.add_label("|Heap:");
+    rw.add_uint(esp.getHeapSize());
+#endif
+    rw.finish(">\r\n");
+    return bf_at;
+}
+
+static void report_send_status(uint8_t client, const char* status, size_t bf_at) {
+    char         report[STATUS_REPORT_SIZE];
+    ReportWriter rw(report, sizeof(report));
+    rw.add(status, bf_at);
+#ifdef REPORT_FIELD_BUFFER_STATE
+    // Returns planner and serial read buffer states.
+    if (bit_istrue(status_mask->get(), RtStatus::Buffer)) {
+        rw.add_label("|Bf:");
+        rw.add_int(plan_get_block_buffer_available());
+        rw.add(',');
+        rw.add_int(report_rx_buffer_available(client));
+    }
 #endif
-    strcat(status, ">\r\n");
-    grbl_send(client, status);
+    rw.add(status + bf_at);
+    client_write_status(client, report);
+}
+
+static bool binary_status[CLIENT_COUNT];
+
+Error report_set_binary_status(uint8_t client, bool enable) {
+    if (client >= CLIENT_COUNT || client == CLIENT_INPUT) {
+        return Error::InvalidValue;
+    }
+    binary_status[client] = enable;
+    return Error::Ok;
+}
+
+bool report_get_binary_status(uint8_t client) {
+    return client < CLIENT_COUNT && binary_status[client];
+}
+
+// Fills in everything but the client specific rx_free and the crc
+static void report_build_status_frame(status_frame_t* frame) {
+    memset(frame, 0, sizeof(*frame));
+    frame->sync[0]      = STATUS_FRAME_SYNC0;
+    frame->sync[1]      = STATUS_FRAME_SYNC1;
+    frame->length       = sizeof(*frame) - offsetof(status_frame_t, version);
+    frame->version      = STATUS_FRAME_VERSION;
+    frame->timestamp_ms = millis();
+    frame->state        = static_cast<uint8_t>(sys.state);
+    frame->n_axis       = number_axis->get();
+    frame->feed_ovr     = sys.f_override;
+    frame->rapid_ovr    = sys.r_override;
+    frame->spindle_ovr  = sys.spindle_speed_ovr;
+    frame->planner_free = plan_get_block_buffer_available();
+    frame->pins         = limits_get_state() | (probe_get_state() << 8) | (system_control_get_state().value << 16);
+#ifdef USE_LINE_NUMBERS
+    plan_block_t* cur_block = plan_get_current_block();
+    if (cur_block != NULL) {
+        frame->line_number = cur_block->line_number;
+    }
+#endif
+    frame->feed_rate   = st_get_realtime_rate();
+    frame->spindle_rpm = sys.spindle_speed;
+    memcpy(frame->steps, sys_position, sizeof(frame->steps));
+}
+
+static void report_send_status_frame(uint8_t client, status_frame_t* frame) {
+    frame->rx_free = report_rx_buffer_available(client);
+    frame->crc     = crc16_ccitt(&frame->version, offsetof(status_frame_t, crc) - offsetof(status_frame_t, version));
+    client_write_status(client, (const uint8_t*)frame, sizeof(*frame));
+}
+
+void report_realtime_status(uint8_t client) {
+    if (report_get_binary_status(client)) {
+        status_frame_t frame;
+        report_build_status_frame(&frame);
+        report_send_status_frame(client, &frame);
+        return;
+    }
+    char   status[STATUS_REPORT_SIZE - STATUS_BF_FIELD_SIZE];
+    size_t bf_at = report_build_status(status, sizeof(status));
+    report_send_status(client, status, bf_at);
+}
+
+// Automatic status reports. Each client can ask for a report every
+// $Report/Interval milliseconds. Due reports are built once and sent to every
+// client that wants one, and a change of state is sent to all of them at once.
+static uint32_t auto_report_interval[CLIENT_COUNT];  // 0 when off
+static uint32_t auto_report_sent[CLIENT_COUNT];      // millis() of the last report
+static State    auto_report_state = State::Idle;
+
+Error report_set_auto_interval(uint8_t client, uint32_t interval_ms) {
+    if (client >= CLIENT_COUNT || client == CLIENT_INPUT) {
+        return Error::InvalidValue;
+    }
+    if (interval_ms && interval_ms < REPORT_AUTO_MIN_INTERVAL_MS) {
+        return Error::NumberRange;
+    }
+    auto_report_interval[client] = interval_ms;
+    auto_report_sent[client]     = millis() - interval_ms;  // Send the first one right away
+    return Error::Ok;
+}
+
+uint32_t report_get_auto_interval(uint8_t client) {
+    return client < CLIENT_COUNT ? auto_report_interval[client] : 0;
+}
+
+uint32_t report_auto_status() {
+    uint32_t now         = millis();
+    bool     changed     = sys.state != auto_report_state;
+    uint32_t wait_ms     = UINT32_MAX;
+    uint8_t  due_clients = 0;
+    auto_report_state    = sys.state;
+    for (uint8_t client = 0; client < CLIENT_COUNT; client++) {
+        uint32_t interval = auto_report_interval[client];
+        if (!interval) {
+            continue;
+        }
+        uint32_t elapsed = now - auto_report_sent[client];
+        if (changed || elapsed >= interval) {
+            due_clients |= bit(client);
+            elapsed = 0;
+        }
+        wait_ms = MIN(wait_ms, MIN(interval - elapsed, uint32_t(REPORT_AUTO_STATE_POLL_MS)));
+    }
+    if (due_clients) {
+        char           status[STATUS_REPORT_SIZE - STATUS_BF_FIELD_SIZE];
+        size_t         bf_at = 0;
+        status_frame_t frame;
+        bool           have_text  = false;
+        bool           have_frame = false;
+        for (uint8_t client = 0; client < CLIENT_COUNT; client++) {
+            if (bit_isfalse(due_clients, bit(client))) {
+                continue;
+            }
+            auto_report_sent[client] = now;
+            if (binary_status[client]) {
+                if (!have_frame) {
+                    report_build_status_frame(&frame);
+                    have_frame = true;
+                }
+                report_send_status_frame(client, &frame);
+            } else {
+                if (!have_text) {
+                    bf_at     = report_build_status(status, sizeof(status));
+                    have_text = true;
+                }
+                report_send_status(client, status, bf_at);
+            }
+        }
+    }
+    return wait_ms;
 }
 
 void report_realtime_steps() {
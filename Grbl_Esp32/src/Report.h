@@ -70,6 +70,17 @@ void grbl_msg_sendf(uint8_t client, MsgLevel level, const char* format, ...);
 void grbl_notify(const char* title, const char* msg);
 void grbl_notifyf(const char* title, const char* format, ...);
 
+// Longest realtime status report, including the line ending
+const int STATUS_REPORT_SIZE = 256;
+
+// Shortest $Report/Interval and how often the state is checked for changes while
+// automatic reports are on
+const int REPORT_AUTO_MIN_INTERVAL_MS = 20;
+const int REPORT_AUTO_STATE_POLL_MS   = 10;
+
+// Formats value with a fixed number of decimals without floating point printf
+char* report_util_fixed(char* buf, float value, int decimals);
+
 // Prints system status messages.
 void report_status_message(Error status_code, uint8_t client);
 void report_realtime_steps();
@@ -95,6 +106,46 @@ void report_echo_line_received(char* line, uint8_t client);
 // Prints realtime status report
 void report_realtime_status(uint8_t client);
 
+// Binary status frame, sent instead of the text status report to clients that turn it on
+// with $Report/Binary=ON. Little endian with no padding. The sync bytes can't occur in
+// text output, so a host can pick frames out of the stream; length counts the bytes from
+// version through crc, and crc is CRC-16/CCITT of the bytes from version up to crc.
+// doc/script/status_frame.py decodes frames and checks them against the text report.
+const uint8_t STATUS_FRAME_SYNC0   = 0xA5;
+const uint8_t STATUS_FRAME_SYNC1   = 0x5A;
+const uint8_t STATUS_FRAME_VERSION = 1;
+
+struct __attribute__((packed)) status_frame_t {
+    uint8_t  sync[2];
+    uint8_t  length;
+    uint8_t  version;
+    uint32_t timestamp_ms;       // millis()
+    uint8_t  state;              // State
+    uint8_t  n_axis;
+    uint8_t  feed_ovr;           // percent
+    uint8_t  rapid_ovr;          // percent
+    uint8_t  spindle_ovr;        // percent
+    uint8_t  planner_free;       // free planner blocks
+    uint16_t rx_free;            // free bytes in the client's receive buffer
+    uint32_t pins;               // bits 0-5 limits by axis, 8 probe, 16-23 control pins
+    uint32_t line_number;        // 0 without USE_LINE_NUMBERS
+    float    feed_rate;          // mm/min
+    uint32_t spindle_rpm;
+    int32_t  steps[MAX_N_AXIS];  // machine position in steps
+    uint16_t crc;
+};
+
+Error report_set_binary_status(uint8_t client, bool enable);
+bool  report_get_binary_status(uint8_t client);
+
+// Sets how often a client gets a status report without asking, 0 for never
+Error    report_set_auto_interval(uint8_t client, uint32_t interval_ms);
+uint32_t report_get_auto_interval(uint8_t client);
+
+// Sends the automatic status reports that are due. Called by the client task.
+// Returns how many milliseconds it can wait before the next call.
+uint32_t report_auto_status();
+
 // Prints recorded probe position
 void report_probe_parameters(uint8_t client);
 
@@ -0,0 +1,154 @@
+#pragma once
+
+/*
+  ReportWriter.h - Bounds checked cursor for building reports
+  Part of Grbl_ESP32
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// This file has no Arduino dependencies so it can be benchmarked on the
+// host; see doc/script/status_report_bench.cpp.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Appends text at a cursor, so building a report is linear in its length
+// instead of rescanning it with every strcat. Writes that don't fit are cut
+// short and remembered in overflowed(). The last 'reserve' bytes of the buffer
+// can only be written by finish(), so a report's terminator always fits.
+class ReportWriter {
+    char* _buf;
+    char* _cursor;
+    char* _limit;  // end of the space for add()
+    char* _end;    // end of the buffer, less room for the '\0'
+    bool  _overflow = false;
+
+public:
+    ReportWriter(char* buf, size_t size, size_t reserve = 0) :
+        _buf(buf), _cursor(buf), _limit(buf + size - 1 - reserve), _end(buf + size - 1) {
+        *_cursor = '\0';
+    }
+
+    char*  c_str() const { return _buf; }
+    size_t length() const { return _cursor - _buf; }
+    bool   overflowed() const { return _overflow; }
+
+    void add(char c) {
+        if (_cursor < _limit) {
+            *_cursor++ = c;
+        } else {
+            _overflow = true;
+        }
+        *_cursor = '\0';
+    }
+
+    void add(const char* text, size_t len) {
+        size_t room = _limit - _cursor;
+        if (len > room) {
+            len       = room;
+            _overflow = true;
+        }
+        memcpy(_cursor, text, len);
+        _cursor += len;
+        *_cursor = '\0';
+    }
+
+    void add(const char* text) { add(text, strlen(text)); }
+
+    // For string literals such as field labels, whose length is known at compile time
+    template <size_t N>
+    void add_label(const char (&label)[N]) {
+        add(label, N - 1);
+    }
+
+    void add_uint(uint32_t value) {
+        char digits[10];
+        int  n = 0;
+        do {
+            digits[n++] = '0' + value % 10;
+            value /= 10;
+        } while (value);
+        while (n) {
+            add(digits[--n]);
+        }
+    }
+
+    void add_int(int32_t value) {
+        if (value < 0) {
+            add('-');
+            add_uint(uint32_t(0) - uint32_t(value));
+        } else {
+            add_uint(uint32_t(value));
+        }
+    }
+
+    // Adds value with a fixed number of decimals (0 to 5) using integer arithmetic,
+    // which is much cheaper than printf's floating point path.
+    void add_fixed(float value, int decimals) {
+        static const uint32_t scales[] = { 1, 10, 100, 1000, 10000, 100000 };
+        if (std::isnan(value)) {
+            add_label("nan");
+            return;
+        }
+        if (decimals < 0) {
+            decimals = 0;
+        } else if (decimals > 5) {
+            decimals = 5;
+        }
+        bool negative = value < 0;
+        if (negative) {
+            value = -value;
+        }
+        if (!(value < 1e12f)) {
+            add(negative ? "-inf" : "inf");
+            return;
+        }
+        // Split first so the fraction keeps all of the float's precision
+        uint64_t whole    = uint64_t(value);
+        uint32_t fraction = uint32_t((value - whole) * scales[decimals] + 0.5f);
+        if (fraction >= scales[decimals]) {
+            whole++;
+            fraction -= scales[decimals];
+        }
+        if (negative && (whole || fraction)) {
+            add('-');  // Like printf, but without "-0.000"
+        }
+        char digits[13];
+        int  n = 0;
+        do {
+            digits[n++] = '0' + whole % 10;
+            whole /= 10;
+        } while (whole);
+        while (n) {
+            add(digits[--n]);
+        }
+        if (decimals) {
+            add('.');
+            for (n = decimals; n; n--) {
+                digits[n - 1] = '0' + fraction % 10;
+                fraction /= 10;
+            }
+            add(digits, decimals);
+        }
+    }
+
+    // Adds text in the reserved space at the end of the buffer
+    void finish(const char* text) {
+        _limit = _end;
+        add(text);
+    }
+};
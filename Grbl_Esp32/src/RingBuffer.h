@@ -0,0 +1,110 @@
+#pragma once
+
+/*
+  RingBuffer.h - Lock-free single producer, single consumer byte ring
+  Part of Grbl_ESP32
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+// One task may write and one other task may read at the same time without
+// any locking. _head is only stored by the writer and _tail only by the reader.
+// The indexes run freely and are masked on access, so the size must be a
+// power of two and all of it is usable.
+class RingBuffer {
+    uint8_t*              _buffer = nullptr;
+    uint32_t              _size   = 0;
+    std::atomic<uint32_t> _head { 0 };
+    std::atomic<uint32_t> _tail { 0 };
+
+public:
+    // Allocates the storage once. size is rounded up to a power of two.
+    bool init(uint32_t size) {
+        uint32_t rounded = 1;
+        while (rounded < size) {
+            rounded <<= 1;
+        }
+        _buffer = static_cast<uint8_t*>(malloc(rounded));
+        _size   = _buffer ? rounded : 0;
+        clear();
+        return _buffer != nullptr;
+    }
+
+    uint32_t size() const { return _size; }
+    uint32_t available() const { return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire); }
+    uint32_t space() const { return _size - available(); }
+
+    // Reader side only; drops everything that has been written so far.
+    void clear() { _tail.store(_head.load(std::memory_order_acquire), std::memory_order_release); }
+
+    // Writer side. Copies all of data or nothing, so a record is never split.
+    bool write(const uint8_t* data, uint32_t len) {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        if (len > _size - (head - _tail.load(std::memory_order_acquire))) {
+            return false;
+        }
+        uint32_t index = head & (_size - 1);
+        uint32_t first = _size - index;
+        if (first > len) {
+            first = len;
+        }
+        memcpy(_buffer + index, data, first);
+        memcpy(_buffer, data + first, len - first);
+        _head.store(head + len, std::memory_order_release);
+        return true;
+    }
+
+    // Reader side. Copies up to len bytes and returns how many were read.
+    uint32_t read(uint8_t* data, uint32_t len) {
+        uint32_t tail  = _tail.load(std::memory_order_relaxed);
+        uint32_t count = _head.load(std::memory_order_acquire) - tail;
+        if (len > count) {
+            len = count;
+        }
+        uint32_t index = tail & (_size - 1);
+        uint32_t first = _size - index;
+        if (first > len) {
+            first = len;
+        }
+        memcpy(data, _buffer + index, first);
+        memcpy(data + first, _buffer, len - first);
+        _tail.store(tail + len, std::memory_order_release);
+        return len;
+    }
+
+    // Reader side. Copies bytes up to and including the first terminator and
+    // returns the count, or 0 if no complete record has been written yet.
+    // A record longer than len is consumed and truncated.
+    uint32_t read_until(uint8_t* data, uint32_t len, uint8_t terminator) {
+        uint32_t tail  = _tail.load(std::memory_order_relaxed);
+        uint32_t count = _head.load(std::memory_order_acquire) - tail;
+        for (uint32_t i = 0; i < count; i++) {
+            uint8_t c = _buffer[(tail + i) & (_size - 1)];
+            if (i < len) {
+                data[i] = c;
+            }
+            if (c == terminator) {
+                _tail.store(tail + i + 1, std::memory_order_release);
+                return i < len ? i + 1 : len;
+            }
+        }
+        return 0;
+    }
+};
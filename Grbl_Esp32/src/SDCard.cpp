@@ -28,6 +28,7 @@ uint8_t                    SD_client     = CLIENT_SERIAL;
 WebUI::AuthenticationLevel SD_auth_level = WebUI::AuthenticationLevel::LEVEL_GUEST;
 uint32_t                   sd_current_line_number;     // stores the most recent line number read from the SD
 static char                comment[LINE_BUFFER_SIZE];  // Line to be executed. Zero-terminated.
+static File                indexFile;                  // sidecar index being built for the running job
 
 // attempt to mount the SD card
 /*bool sd_mount()
@@ -82,11 +83,179 @@ boolean closeFile() {
     set_sd_state(SDState::Idle);
     SD_ready_next          = false;
     sd_current_line_number = 0;
+    if (indexFile) {
+        indexFile.close();
+    }
     myFile.close();
     SD.end();
     return true;
 }
 
+static String sd_index_path() {
+    return String(myFile.name()) + ".idx";
+}
+
+// Opens the index of the current job file and checks that it was built for this
+// version of the file and this firmware's record layout. Returns the number of records.
+static uint32_t sd_index_open(File& index) {
+    index = SD.open(sd_index_path());
+    if (!index) {
+        return 0;
+    }
+    sd_index_header_t header;
+    if (index.read((uint8_t*)&header, sizeof(header)) != sizeof(header) || header.magic != SD_INDEX_MAGIC ||
+        header.version != SD_INDEX_VERSION || header.interval != SD_LINE_INDEX_INTERVAL || header.record_size != sizeof(sd_index_record_t) ||
+        header.file_size != myFile.size() || header.file_time != uint32_t(myFile.getLastWrite())) {
+        index.close();
+        return 0;
+    }
+    // A partial index, e.g. from a job that was interrupted, is still usable
+    return (index.size() - sizeof(header)) / sizeof(sd_index_record_t);
+}
+
+static bool sd_index_read_record(File& index, uint32_t n, sd_index_record_t& record) {
+    return index.seek(sizeof(sd_index_header_t) + n * sizeof(sd_index_record_t)) &&
+           index.read((uint8_t*)&record, sizeof(record)) == sizeof(record);
+}
+
+static void sd_index_write_record(uint32_t offset) {
+    sd_index_record_t record;
+    record.line_number   = sd_current_line_number;
+    record.offset        = offset;
+    record.modal         = gc_state.modal;
+    record.feed_rate     = gc_state.feed_rate;
+    record.spindle_speed = gc_state.spindle_speed;
+    indexFile.write((const uint8_t*)&record, sizeof(record));
+    indexFile.flush();  // keep the index usable if the job never finishes
+}
+
+// Called when a job is run from the top. Builds the index while the job streams,
+// unless a complete index for this file already exists.
+void sd_index_start() {
+    if (!myFile || SD_LINE_INDEX_INTERVAL == 0) {
+        return;
+    }
+    File              index;
+    uint32_t          count = sd_index_open(index);
+    sd_index_record_t last;
+    if (count) {
+        bool complete = sd_index_read_record(index, count - 1, last) && last.offset == myFile.size();
+        index.close();
+        if (complete) {
+            return;
+        }
+    }
+    indexFile = SD.open(sd_index_path(), FILE_WRITE);
+    if (!indexFile) {
+        return;
+    }
+    sd_index_header_t header = {
+        SD_INDEX_MAGIC, SD_INDEX_VERSION, SD_LINE_INDEX_INTERVAL, sizeof(sd_index_record_t), myFile.size(), uint32_t(myFile.getLastWrite())
+    };
+    indexFile.write((const uint8_t*)&header, sizeof(header));
+}
+
+// Positions the current job so that the next line read is the given line, with the
+// parser state it would have had. The nearest indexed line at or before it is used as
+// the starting point and the remaining lines are parsed in check mode. Without an
+// index the whole file up to that line is parsed. Realtime commands are served while
+// parsing, and a line that fails to parse or a reset ends the seek with the parser
+// state it had before.
+Error sd_seek_line(uint32_t line) {
+    if (!myFile) {
+        return Error::FsFailedRead;
+    }
+    parser_state_t saved_gc = gc_state;
+    File           index;
+    uint32_t       count = sd_index_open(index);
+    if (count) {
+        // Records are in line order; find the last one at or before the line
+        sd_index_record_t record, found = {};
+        uint32_t          lo = 0, hi = count;
+        while (lo < hi) {
+            uint32_t mid = (lo + hi) / 2;
+            if (!sd_index_read_record(index, mid, record)) {
+                hi = mid;
+            } else if (record.line_number <= line) {
+                found = record;
+                lo    = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        if (found.line_number && myFile.seek(found.offset)) {
+            sd_current_line_number = found.line_number - 1;
+            gc_state.modal         = found.modal;
+            gc_state.feed_rate     = found.feed_rate;
+            gc_state.spindle_speed = found.spindle_speed;
+        }
+        index.close();
+    }
+    if (sd_current_line_number + 1 < line) {
+        grbl_msg_sendf(SD_client, MsgLevel::Info, "Parsing from line %d", sd_current_line_number + 1);
+    }
+
+    // Parse the remaining lines in check mode so nothing moves or switches
+    char  fileLine[255];
+    Error err         = Error::Ok;
+    State saved_state = sys.state;
+    sys.state         = State::CheckMode;
+    set_sd_state(SDState::BusyParsing);
+    while (sd_current_line_number + 1 < line) {
+        if (!readFileLine(fileLine, 255)) {
+            err = Error::FsFileEmpty;
+            break;
+        }
+        // System commands are not replayed
+        if (fileLine[0] != '$' && fileLine[0] != '[') {
+            err = gc_execute_line(fileLine, SD_client);
+            if (err == Error::GcodeUnsupportedCommand) {
+                err = Error::Ok;  // The job goes on past these too; see report_status_message()
+            } else if (err != Error::Ok) {
+                grbl_msg_sendf(SD_client, MsgLevel::Error, "Line %d does not parse", sd_current_line_number);
+                break;
+            }
+        }
+        protocol_execute_realtime();  // A long parse must still answer status queries and a reset
+        if (sys.abort) {
+            err = Error::IdleError;  // Reset while parsing
+            break;
+        }
+    }
+    sys.state = saved_state;
+    set_sd_state(SDState::BusyPrinting);
+    if (err != Error::Ok) {
+        gc_state = saved_gc;
+        return err;
+    }
+    gc_sync_position();
+
+    // The parser now holds the modal state of the line, but the outputs are still off.
+    // Re-issue the coordinate system, spindle and coolant so they take effect.
+    CoolantState coolant   = gc_state.modal.coolant;
+    SpindleState spindle   = gc_state.modal.spindle;
+    gc_state.modal.coolant = {};
+    gc_state.modal.spindle = SpindleState::Disable;
+    char preamble[20];
+    snprintf(preamble,
+             sizeof(preamble),
+             "G%d%s",
+             54 + static_cast<int>(gc_state.modal.coord_select),
+             spindle == SpindleState::Cw ? "M3" : (spindle == SpindleState::Ccw ? "M4" : ""));
+    grbl_msg_sendf(SD_client, MsgLevel::Info, "Resume at line %d", line);
+    err = gc_execute_line(preamble, SD_client);
+    // Only one coolant word is allowed per block
+    if (err == Error::Ok && coolant.Mist) {
+        strcpy(preamble, "M7");
+        err = gc_execute_line(preamble, SD_client);
+    }
+    if (err == Error::Ok && coolant.Flood) {
+        strcpy(preamble, "M8");
+        err = gc_execute_line(preamble, SD_client);
+    }
+    return err;
+}
+
 /*
   read a line from the SD card
   strip whitespace
@@ -100,6 +269,9 @@ boolean readFileLine(char* line, int maxlen) {
         return false;
     }
     sd_current_line_number += 1;
+    if (indexFile && (sd_current_line_number - 1) % SD_LINE_INDEX_INTERVAL == 0) {
+        sd_index_write_record(myFile.position());
+    }
     int len = 0;
     while (myFile.available()) {
         if (len >= maxlen) {
@@ -112,7 +284,15 @@ boolean readFileLine(char* line, int maxlen) {
         line[len++] = c;
     }
     line[len] = '\0';
-    return len || myFile.available();
+    if (len || myFile.available()) {
+        return true;
+    }
+    if (indexFile) {
+        // The end record marks the index as complete
+        sd_index_write_record(myFile.size());
+        indexFile.close();
+    }
+    return false;
 }
 
 // return a percentage complete 50.5 = 50.5%
@@ -165,10 +345,10 @@ SDState set_sd_state(SDState state) {
 }
 
 void sd_get_current_filename(char* name) {
-    if (myFile) {
-        strcpy(name, myFile.name());
-    } else {
-        name[0] = 0;
-    }
+    strcpy(name, sd_current_filename());
+}
+
+const char* sd_current_filename() {
+    return myFile ? myFile.name() : "";
 }
 #endif  //ENABLE_SD_CARD
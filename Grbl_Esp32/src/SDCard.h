@@ -32,18 +32,43 @@ enum class SDState : uint8_t {
     BusyParsing   = 4,
 };
 
+// Sidecar line index "<file>.idx": a header followed by fixed size records, one every
+// SD_LINE_INDEX_INTERVAL lines. A complete index ends with a record whose offset is the file size.
+const uint32_t SD_INDEX_MAGIC   = 0x58444E49;  // "INDX"
+const uint16_t SD_INDEX_VERSION = 2;
+
+struct sd_index_header_t {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t interval;
+    uint32_t record_size;
+    uint32_t file_size;  // size of the job file when the index was built
+    uint32_t file_time;  // last write time of the job file then, so an edit of the same size is caught
+};
+
+struct sd_index_record_t {
+    uint32_t   line_number;    // line that starts at offset (1 based)
+    uint32_t   offset;         // byte offset of the start of the line
+    gc_modal_t modal;          // parser modal state before the line runs
+    float      feed_rate;      // parser feed rate before the line runs
+    float      spindle_speed;  // parser spindle speed before the line runs
+};
+
 extern bool                       SD_ready_next;  // Grbl has processed a line and is waiting for another
 extern uint8_t                    SD_client;
 extern WebUI::AuthenticationLevel SD_auth_level;
 
 //bool sd_mount();
-SDState  get_sd_state(bool refresh);
-SDState  set_sd_state(SDState state);
-void     listDir(fs::FS& fs, const char* dirname, uint8_t levels, uint8_t client);
-boolean  openFile(fs::FS& fs, const char* path);
-boolean  closeFile();
-boolean  readFileLine(char* line, int len);
-void     readFile(fs::FS& fs, const char* path);
-float    sd_report_perc_complete();
-uint32_t sd_get_current_line_number();
-void     sd_get_current_filename(char* name);
+SDState     get_sd_state(bool refresh);
+SDState     set_sd_state(SDState state);
+void        listDir(fs::FS& fs, const char* dirname, uint8_t levels, uint8_t client);
+boolean     openFile(fs::FS& fs, const char* path);
+boolean     closeFile();
+boolean     readFileLine(char* line, int len);
+void        readFile(fs::FS& fs, const char* path);
+float       sd_report_perc_complete();
+uint32_t    sd_get_current_line_number();
+void        sd_get_current_filename(char* name);
+const char* sd_current_filename();
+void        sd_index_start();
+Error       sd_seek_line(uint32_t line);
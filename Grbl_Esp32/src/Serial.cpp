@@ -48,14 +48,29 @@
 
   To allow the realtime commands to be randomly mixed in the stream of data, we
   read all clients as fast as possible. The realtime commands are acted upon and the other charcters are
-  placed into a client_buffer[client].
+  assembled into lines here, then each complete line is placed into a client_buffer[client].
 
-  The main protocol loop reads from client_buffer[]
+  The main protocol loop reads whole lines from client_buffer[]. Each client_buffer[] is a lock-free ring
+  with this task as its only writer and the protocol loop as its only reader, so no critical sections
+  are needed on either side.
+
+  Output goes the other way through client_tx[]. client_write() only copies the text into the
+  client's ring and clientTxTask sends it, so a slow WiFi or Bluetooth peer can not hold up the
+  protocol loop as long as its ring has room. When the serial port's ring is full, the writer
+  waits for clientTxTask to drain it, so replies and long dumps like $$ are never cut short.
+  A network or Bluetooth peer that stops reading must not stall motion, so for those clients
+  the writer waits at most CLIENT_TX_WAIT_MS; after that the client is marked stalled and its
+  output is dropped and counted until clientTxTask has emptied its ring. Output from the
+  realtime path, which must not wait at all, is dropped and counted too. Status reports have their own
+  slot per client which a newer report overwrites, so a backed up client gets the latest
+  position instead of a queue of stale ones. The slot remembers how much ring data came before
+  it and is sent in that place.
 
 
 */
 
 #include "Grbl.h"
+#include "RingBuffer.h"
 
 // Define this to use the Arduino serial (UART) driver instead
 // of the one in Uart.cpp, which uses the ESP-IDF UART driver.
@@ -63,22 +78,81 @@
 // testing is complete.
 // #define REVERT_TO_ARDUINO_SERIAL
 
-portMUX_TYPE myMutex = portMUX_INITIALIZER_UNLOCKED;
-
 static TaskHandle_t clientCheckTaskHandle = 0;
-
-WebUI::InputBuffer client_buffer[CLIENT_COUNT];  // create a buffer for each client
-
-// Returns the number of bytes available in a client buffer.
-uint8_t client_get_rx_buffer_available(uint8_t client) {
+static TaskHandle_t clientTxTaskHandle    = 0;
+
+// clientCheckTask blocks on this set, which holds the UART0 event queue and clientWake
+static const int         UART0_EVENT_QUEUE_SIZE = 20;
+static QueueSetHandle_t  clientEventSet         = NULL;
+static SemaphoreHandle_t clientWake             = NULL;
+
+RingBuffer client_buffer[CLIENT_COUNT];  // create a buffer for each client
+
+// Each line in client_buffer[] is stored as a type byte, the text and a terminating '\0'
+enum class LineRecord : uint8_t {
+    Line     = 1,
+    Overflow = 2,  // The line was too long; its text was dropped
+};
+
+// Lines being assembled by clientCheckTask. Only that task touches these.
+typedef struct {
+    uint8_t           record[LINE_BUFFER_SIZE + 1];  // type byte + text + '\0'
+    int               len;
+    bool              overflow;
+    bool              pending;  // complete, waiting for room in client_buffer[]
+    std::atomic<bool> reset;    // set by the reader to discard the partial line
+} client_line_t;
+static client_line_t client_lines[CLIENT_COUNT];
+
+// Output waiting for clientTxTask. Any task may write, so writers hold clientTxSpinlock;
+// clientTxTask is the only reader.
+typedef struct {
+    RingBuffer ring;
+    uint8_t    status[STATUS_REPORT_SIZE];  // newest unsent status report
+    size_t     status_len;                  // 0 if none
+    uint32_t   status_at;                   // the value of queued when the report was stored
+    uint32_t   queued;                      // bytes ever written to the ring
+    uint32_t   sent;                        // bytes ever read from the ring by clientTxTask
+    uint32_t   dropped;                     // bytes discarded because the ring was full
+    bool       stalled;                     // gave up waiting for room; drop until the ring empties
+    uint32_t   coalesced;                   // status reports replaced before they were sent
+    uint32_t   high_water;                  // most bytes ever waiting in the ring
+} client_tx_t;
+static client_tx_t       client_tx[CLIENT_COUNT];
+static portMUX_TYPE      clientTxSpinlock = portMUX_INITIALIZER_UNLOCKED;
+static SemaphoreHandle_t clientTxWake     = NULL;
+
+// Returns the number of bytes a sender may still send to a client. Everything that has been
+// received but not yet executed counts against RX_BUFFER_SIZE: bytes in the driver, the
+// line being assembled, and complete lines waiting in client_buffer[].
+int client_get_rx_buffer_available(uint8_t client) {
 #ifdef REVERT_TO_ARDUINO_SERIAL
-    return 128 - Serial.available();
+    int used = Serial.available();
 #else
-    return 128 - Uart0.available();
+    int used = Uart0.available();
 #endif
-    //    return client_buffer[client].availableforwrite();
+    used += client_lines[client].len + client_buffer[client].available();
+    return used < RX_BUFFER_SIZE ? RX_BUFFER_SIZE - used : 0;
 }
 
+#ifdef SERIAL_FLOW_CONTROL_XON_XOFF
+static const uint8_t XON          = 0x11;
+static const uint8_t XOFF         = 0x13;
+static bool          serialPaused = false;
+
+// Pauses the sender as the serial RX buffer fills and resumes it once it has drained
+static void serial_flow_control() {
+    int available = client_get_rx_buffer_available(CLIENT_SERIAL);
+    if (!serialPaused && available < RX_BUFFER_SIZE / 4) {
+        serialPaused = true;
+        Uart0.write(XOFF);
+    } else if (serialPaused && available > RX_BUFFER_SIZE * 3 / 4) {
+        serialPaused = false;
+        Uart0.write(XON);
+    }
+}
+#endif
+
 void heapCheckTask(void* pvParameters) {
     static uint32_t heapSize = 0;
     while (true) {
@@ -102,17 +176,40 @@ void client_init() {
     xTaskCreatePinnedToCore(heapCheckTask, "heapTask", 2000, NULL, 1, NULL, 1);
 #endif
 
+    for (uint8_t client = 0; client < CLIENT_COUNT; client++) {
+        client_buffer[client].init(CLIENT_RX_RING_SIZE);
+        if (client != CLIENT_INPUT) {
+            client_tx[client].ring.init(CLIENT_TX_RING_SIZE);
+        }
+    }
+
 #ifdef REVERT_TO_ARDUINO_SERIAL
+    Serial.setRxBufferSize(RX_BUFFER_SIZE);
     Serial.begin(BAUD_RATE, SERIAL_8N1, 3, 1, false);
     client_reset_read_buffer(CLIENT_ALL);
     Serial.write("\r\n");  // create some white space after ESP32 boot info
 #else
+#    ifdef SERIAL_FLOW_CONTROL_RTS_CTS
+    Uart0.setPins(1, 3, SERIAL_RTS_PIN, SERIAL_CTS_PIN);  // Tx 1, Rx 3 - standard hardware pins
+#    else
     Uart0.setPins(1, 3);  // Tx 1, Rx 3 - standard hardware pins
-    Uart0.begin(BAUD_RATE, Uart::Data::Bits8, Uart::Stop::Bits1, Uart::Parity::None);
+#    endif
+    Uart0.setRxBufferSize(RX_BUFFER_SIZE);
+    Uart0.begin(BAUD_RATE, Uart::Data::Bits8, Uart::Stop::Bits1, Uart::Parity::None, UART0_EVENT_QUEUE_SIZE);
+#    ifdef SERIAL_FLOW_CONTROL_RTS_CTS
+    Uart0.setHwFlowControl(UART_FIFO_LEN - 8);
+#    endif
 
     client_reset_read_buffer(CLIENT_ALL);
     Uart0.write("\r\n");  // create some white space after ESP32 boot info
 #endif
+    clientWake     = xSemaphoreCreateBinary();
+    clientEventSet = xQueueCreateSet(UART0_EVENT_QUEUE_SIZE + 1);
+    xQueueAddToSet(clientWake, clientEventSet);
+#ifndef REVERT_TO_ARDUINO_SERIAL
+    xQueueAddToSet(Uart0.eventQueue(), clientEventSet);
+#endif
+
     clientCheckTaskHandle = 0;
     // create a task to check for incoming data
     // For a 4096-word stack, uxTaskGetStackHighWaterMark reports 244 words available
@@ -121,30 +218,40 @@ void client_init() {
                             "clientCheckTask",  // name for task
                             8192,               // size of task stack
                             NULL,               // parameters
-                            1,                  // priority
+                            2,                  // priority; above the protocol loop so realtime commands preempt it
                             &clientCheckTaskHandle,
                             SUPPORT_TASK_CORE  // must run the task on same core
                                                // core
     );
+
+    clientTxWake = xSemaphoreCreateBinary();
+    xTaskCreatePinnedToCore(clientTxTask,    // task
+                            "clientTxTask",  // name for task
+                            4096,            // size of task stack
+                            NULL,            // parameters
+                            1,               // priority
+                            &clientTxTaskHandle,
+                            SUPPORT_TASK_CORE  // must run the task on same core
+    );
 }
 
 static uint8_t getClientChar(uint8_t* data) {
     int res;
 #ifdef REVERT_TO_ARDUINO_SERIAL
-    if (client_buffer[CLIENT_SERIAL].availableforwrite() && (res = Serial.read()) != -1) {
+    if (!client_lines[CLIENT_SERIAL].pending && (res = Serial.read()) != -1) {
 #else
-    if (client_buffer[CLIENT_SERIAL].availableforwrite() && (res = Uart0.read()) != -1) {
+    if (!client_lines[CLIENT_SERIAL].pending && (res = Uart0.read()) != -1) {
 #endif
         *data = res;
         return CLIENT_SERIAL;
     }
-    if (WebUI::inputBuffer.available()) {
+    if (!client_lines[CLIENT_INPUT].pending && WebUI::inputBuffer.available()) {
         *data = WebUI::inputBuffer.read();
         return CLIENT_INPUT;
     }
     //currently is wifi or BT but better to prepare both can be live
 #ifdef ENABLE_BLUETOOTH
-    if (WebUI::SerialBT.hasClient()) {
+    if (!client_lines[CLIENT_BT].pending && WebUI::SerialBT.hasClient()) {
         if ((res = WebUI::SerialBT.read()) != -1) {
             *data = res;
             return CLIENT_BT;
@@ -152,13 +259,13 @@ static uint8_t getClientChar(uint8_t* data) {
     }
 #endif
 #if defined(ENABLE_WIFI) && defined(ENABLE_HTTP) && defined(ENABLE_SERIAL2SOCKET_IN)
-    if (WebUI::Serial2Socket.available()) {
+    if (!client_lines[CLIENT_WEBUI].pending && WebUI::Serial2Socket.available()) {
         *data = WebUI::Serial2Socket.read();
         return CLIENT_WEBUI;
     }
 #endif
 #if defined(ENABLE_WIFI) && defined(ENABLE_TELNET)
-    if (WebUI::telnet_server.available()) {
+    if (!client_lines[CLIENT_TELNET].pending && WebUI::telnet_server.available()) {
         *data = WebUI::telnet_server.read();
         return CLIENT_TELNET;
     }
@@ -166,25 +273,120 @@ static uint8_t getClientChar(uint8_t* data) {
     return CLIENT_ALL;
 }
 
+// Moves a completed line into the client's buffer. If there is no room the line stays
+// pending and getClientChar() stops reading that client until the reader catches up.
+static void commit_line(uint8_t client) {
+    client_line_t* cl = &client_lines[client];
+    if (client_buffer[client].write(cl->record, cl->len + 2)) {
+        cl->len      = 0;
+        cl->overflow = false;
+        cl->pending  = false;
+    }
+}
+
+// Simple editing for interactive input plus line framing. The text of an
+// overlong line is dropped up to its end so the reader sees a single error.
+static void add_char_to_line(uint8_t c, uint8_t client) {
+    client_line_t* cl = &client_lines[client];
+    if (c == '\b') {
+        // Backspace erases
+        if (cl->len && !cl->overflow) {
+            --cl->len;
+        }
+        return;
+    }
+    if (c == '\0') {
+        return;  // Would end the line early
+    }
+    if (c == '\r' || c == '\n') {
+        cl->record[0] = static_cast<uint8_t>(LineRecord::Line);
+        if (cl->overflow) {
+            cl->record[0] = static_cast<uint8_t>(LineRecord::Overflow);
+            cl->len       = 0;
+        }
+        cl->record[cl->len + 1] = '\0';
+        cl->pending             = true;
+        commit_line(client);
+        return;
+    }
+    if (cl->len == (LINE_BUFFER_SIZE - 1)) {
+        cl->overflow = true;
+        return;
+    }
+    cl->record[++cl->len] = c;
+}
+
+void client_notify() {
+    if (clientWake) {
+        xSemaphoreGive(clientWake);
+    }
+}
+
+// Blocks until there may be new input. UART data and client_notify() wake the task at
+// once. WiFi sockets can only be polled, so with WiFi on the wait is limited to one tick.
+static void client_wait(uint32_t max_ms) {
+    for (uint8_t client = 0; client < CLIENT_COUNT; client++) {
+        if (client_lines[client].pending) {
+            // Waiting for the protocol loop to make room; new input would not be read anyway
+            vTaskDelay(1);
+            return;
+        }
+    }
+    TickType_t ticks = MIN(uint32_t(CLIENT_IDLE_POLL_MS), max_ms) / portTICK_PERIOD_MS;
+    if (ticks == 0) {
+        ticks = 1;
+    }
+#ifdef ENABLE_WIFI
+    if (WiFi.getMode() != WIFI_OFF) {
+        ticks = 1;
+    }
+#endif
+#ifdef SERIAL_FLOW_CONTROL_XON_XOFF
+    if (serialPaused) {
+        ticks = 1;  // Watch for the buffer to drain so XON is sent promptly
+    }
+#endif
+    QueueSetMemberHandle_t member = xQueueSelectFromSet(clientEventSet, ticks);
+    if (member == clientWake) {
+        xSemaphoreTake(clientWake, 0);
+    } else if (member != NULL) {
+        uart_event_t event;
+        xQueueReceive(member, &event, 0);
+    }
+}
+
 // this task runs and checks for data on all interfaces
-// REaltime stuff is acted upon, then characters are added to the appropriate buffer
+// REaltime stuff is acted upon, then characters are assembled into lines for the appropriate buffer
 void clientCheckTask(void* pvParameters) {
     uint8_t            data = 0;
     uint8_t            client;  // who sent the data
     static UBaseType_t uxHighWaterMark = 0;
     while (true) {  // run continuously
+        for (client = 0; client < CLIENT_COUNT; client++) {
+            client_line_t* cl = &client_lines[client];
+            if (cl->reset.exchange(false)) {
+                cl->len      = 0;
+                cl->overflow = false;
+                cl->pending  = false;
+            }
+            if (cl->pending) {
+                commit_line(client);
+            }
+        }
+#ifdef SERIAL_FLOW_CONTROL_XON_XOFF
+        serial_flow_control();
+#endif
         while ((client = getClientChar(&data)) != CLIENT_ALL) {
             // Pick off realtime command characters directly from the serial stream. These characters are
             // not passed into the main buffer, but these set system state flag bits for realtime execution.
             if (is_realtime_command(data)) {
+                rt_trace_rx(static_cast<Cmd>(data), client);
                 execute_realtime_command(static_cast<Cmd>(data), client);
             } else {
 #if defined(ENABLE_SD_CARD)
                 if (get_sd_state(false) < SDState::Busy) {
 #endif  //ENABLE_SD_CARD
-                    vTaskEnterCritical(&myMutex);
-                    client_buffer[client].write(data);
-                    vTaskExitCritical(&myMutex);
+                    add_char_to_line(data, client);
 #if defined(ENABLE_SD_CARD)
                 } else {
                     if (data == '\r' || data == '\n') {
@@ -195,6 +397,9 @@ void clientCheckTask(void* pvParameters) {
 #endif  //ENABLE_SD_CARD
             }
         }  // if something available
+#ifdef SERIAL_FLOW_CONTROL_XON_XOFF
+        serial_flow_control();
+#endif
         WebUI::COMMANDS::handle();
 #ifdef ENABLE_WIFI
         WebUI::wifi_config.handle();
@@ -205,7 +410,7 @@ void clientCheckTask(void* pvParameters) {
 #if defined(ENABLE_WIFI) && defined(ENABLE_HTTP) && defined(ENABLE_SERIAL2SOCKET_IN)
         WebUI::Serial2Socket.handle_flush();
 #endif
-        vTaskDelay(1 / portTICK_RATE_MS);  // Yield to other tasks
+        client_wait(report_auto_status());  // Yield to other tasks until there is something to do
 
         static UBaseType_t uxHighWaterMark = 0;
 #ifdef DEBUG_TASK_STACK
@@ -217,17 +422,28 @@ void clientCheckTask(void* pvParameters) {
 void client_reset_read_buffer(uint8_t client) {
     for (uint8_t client_num = 0; client_num < CLIENT_COUNT; client_num++) {
         if (client == client_num || client == CLIENT_ALL) {
-            client_buffer[client_num].begin();
+            client_buffer[client_num].clear();
+            client_lines[client_num].reset = true;
         }
     }
 }
 
-// Fetches the first byte in the client read buffer. Called by protocol loop.
-int client_read(uint8_t client) {
-    vTaskEnterCritical(&myMutex);
-    int data = client_buffer[client].read();
-    vTaskExitCritical(&myMutex);
-    return data;
+// Fetches the next complete line from a client into line, which must hold LINE_BUFFER_SIZE
+// characters. Returns Error::Eol when a line was fetched, Error::Overflow when the line
+// was too long and was discarded, or Error::Ok when no complete line is waiting.
+// Called by protocol loop.
+Error client_read_line(uint8_t client, char* line) {
+    uint8_t  record[LINE_BUFFER_SIZE + 1];
+    uint32_t len = client_buffer[client].read_until(record, sizeof(record), '\0');
+    if (len == 0) {
+        return Error::Ok;
+    }
+    if (static_cast<LineRecord>(record[0]) == LineRecord::Overflow) {
+        line[0] = '\0';
+        return Error::Overflow;
+    }
+    memcpy(line, record + 1, len - 1);
+    return Error::Eol;
 }
 
 // checks to see if a character is a realtime character
@@ -243,8 +459,9 @@ bool is_realtime_command(uint8_t data) {
 void execute_realtime_command(Cmd command, uint8_t client) {
     switch (command) {
         case Cmd::Reset:
-            grbl_msg_sendf(CLIENT_ALL, MsgLevel::Debug, "Cmd::Reset");
             mc_reset();  // Call motion control reset routine.
+            rt_trace_stage(RtEvent::Reset, RtStage::Flag);
+            grbl_msg_sendf(CLIENT_ALL, MsgLevel::Debug, "Cmd::Reset");
             break;
         case Cmd::StatusReport:
             report_realtime_status(client);  // direct call instead of setting flag
@@ -254,6 +471,7 @@ void execute_realtime_command(Cmd command, uint8_t client) {
             break;
         case Cmd::FeedHold:
             sys_rt_exec_state.bit.feedHold = true;
+            rt_trace_stage(RtEvent::FeedHold, RtStage::Flag);
             // spindle->stop();
             // coolant_stop();
             // sys.spindle_stop_ovr.value = 1;
@@ -347,33 +565,217 @@ void execute_realtime_command(Cmd command, uint8_t client) {
             sys_rt_exec_accessory_override.bit.coolantMistOvrToggle = 1;
             break;
     }
+    if (command >= Cmd::FeedOvrReset && command <= Cmd::SpindleOvrFineMinus) {
+        rt_trace_stage(RtEvent::Override, RtStage::Flag);
+    }
 }
 
-void client_write(uint8_t client, const char* text) {
-    if (client == CLIENT_INPUT) {
-        return;
-    }
+// Sends directly to one client's transport. This may block on a slow peer,
+// so only clientTxTask uses it once the task is running.
+static void client_transport_write(uint8_t client, const uint8_t* data, size_t len) {
+    switch (client) {
 #ifdef ENABLE_BLUETOOTH
-    if (WebUI::SerialBT.hasClient() && (client == CLIENT_BT || client == CLIENT_ALL)) {
-        WebUI::SerialBT.print(text);
-        //delay(10); // possible fix for dropped characters
-    }
+        case CLIENT_BT:
+            if (WebUI::SerialBT.hasClient()) {
+                WebUI::SerialBT.write(data, len);
+            }
+            break;
 #endif
 #if defined(ENABLE_WIFI) && defined(ENABLE_HTTP) && defined(ENABLE_SERIAL2SOCKET_OUT)
-    if (client == CLIENT_WEBUI || client == CLIENT_ALL) {
-        WebUI::Serial2Socket.write((const uint8_t*)text, strlen(text));
-    }
+        case CLIENT_WEBUI:
+            WebUI::Serial2Socket.write(data, len);
+            break;
 #endif
 #if defined(ENABLE_WIFI) && defined(ENABLE_TELNET)
-    if (client == CLIENT_TELNET || client == CLIENT_ALL) {
-        WebUI::telnet_server.write((const uint8_t*)text, strlen(text));
-    }
+        case CLIENT_TELNET:
+            WebUI::telnet_server.write(data, len);
+            break;
 #endif
-    if (client == CLIENT_SERIAL || client == CLIENT_ALL) {
+        case CLIENT_SERIAL:
 #ifdef REVERT_TO_ARDUINO_SERIAL
-        Serial.write(text);
+            Serial.write(data, len);
 #else
-        Uart0.write(text);
+            Uart0.write(data, len);
+#endif
+            break;
+        default:
+            break;
+    }
+}
+
+static bool client_has_transport(uint8_t client) {
+    switch (client) {
+        case CLIENT_SERIAL:
+            return true;
+#ifdef ENABLE_BLUETOOTH
+        case CLIENT_BT:
+            return WebUI::SerialBT.hasClient();
+#endif
+#if defined(ENABLE_WIFI) && defined(ENABLE_HTTP) && defined(ENABLE_SERIAL2SOCKET_OUT)
+        case CLIENT_WEBUI:
+            return true;
 #endif
+#if defined(ENABLE_WIFI) && defined(ENABLE_TELNET)
+        case CLIENT_TELNET:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+// Sends everything queued for each client, in the order it was written. A status
+// report goes out once the ring data that came before it has been sent.
+void clientTxTask(void* pvParameters) {
+    uint8_t            chunk[STATUS_REPORT_SIZE];
+    static UBaseType_t uxHighWaterMark = 0;
+    while (true) {
+        xSemaphoreTake(clientTxWake, portMAX_DELAY);
+        for (uint8_t client = 0; client < CLIENT_COUNT; client++) {
+            client_tx_t* tx = &client_tx[client];
+            if (tx->ring.size() == 0) {
+                continue;
+            }
+            while (true) {
+                size_t len    = sizeof(chunk);
+                bool   status = false;
+                portENTER_CRITICAL(&clientTxSpinlock);
+                if (tx->queued - tx->sent < len) {
+                    len = tx->queued - tx->sent;  // Nothing written after this point yet
+                }
+                if (tx->status_len) {
+                    if (tx->status_at == tx->sent) {
+                        len = tx->status_len;
+                        memcpy(chunk, tx->status, len);
+                        tx->status_len = 0;
+                        status         = true;
+                    } else if (tx->status_at - tx->sent < len) {
+                        len = tx->status_at - tx->sent;  // Stop at the report
+                    }
+                }
+                portEXIT_CRITICAL(&clientTxSpinlock);
+                if (!status) {
+                    len = tx->ring.read(chunk, len);
+                    if (len == 0) {
+                        portENTER_CRITICAL(&clientTxSpinlock);
+                        tx->stalled = false;  // Drained, so the writers may wait for it again
+                        portEXIT_CRITICAL(&clientTxSpinlock);
+                        break;
+                    }
+                    tx->sent += len;
+                }
+                client_transport_write(client, chunk, len);
+            }
+        }
+
+#ifdef DEBUG_TASK_STACK
+        reportTaskStackSize(uxHighWaterMark);
+#endif
+    }
+}
+
+// The realtime path reads commands like feed hold, so it must not wait for a slow client
+static bool client_can_wait() {
+    if (xPortInIsrContext()) {
+        return false;
+    }
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    return task != clientCheckTaskHandle && task != clientTxTaskHandle;
+}
+
+static void client_queue(uint8_t client, const uint8_t* data, size_t len, bool status) {
+    client_tx_t* tx = &client_tx[client];
+    if (!clientTxTaskHandle || tx->ring.size() == 0) {
+        client_transport_write(client, data, len);  // Not started yet
+        return;
+    }
+    while (len > tx->ring.size()) {  // Could never fit at once
+        client_queue(client, data, tx->ring.size(), status);
+        data += tx->ring.size();
+        len -= tx->ring.size();
+    }
+    bool     wait  = !status && client_can_wait();
+    uint32_t start = millis();
+    while (true) {
+        bool done = true;
+        portENTER_CRITICAL(&clientTxSpinlock);
+        if (status && len <= STATUS_REPORT_SIZE) {
+            if (tx->status_len) {
+                tx->coalesced++;
+            }
+            memcpy(tx->status, data, len);
+            tx->status_len = len;
+            tx->status_at  = tx->queued;
+        } else if (tx->ring.write(data, len)) {
+            tx->queued += len;
+            uint32_t used = tx->ring.available();
+            if (used > tx->high_water) {
+                tx->high_water = used;
+            }
+        } else if (wait && !tx->stalled) {
+            done = false;
+        } else {
+            tx->dropped += len;
+        }
+        portEXIT_CRITICAL(&clientTxSpinlock);
+        xSemaphoreGive(clientTxWake);
+        if (done || !client_has_transport(client)) {
+            return;
+        }
+        if (client != CLIENT_SERIAL && millis() - start >= CLIENT_TX_WAIT_MS) {
+            portENTER_CRITICAL(&clientTxSpinlock);
+            tx->stalled = true;  // The next pass drops this message, and later ones don't wait
+            portEXIT_CRITICAL(&clientTxSpinlock);
+            continue;
+        }
+        vTaskDelay(1);  // Let clientTxTask make room
+    }
+}
+
+static void client_write_queued(uint8_t client, const uint8_t* data, size_t len, bool status) {
+    if (client == CLIENT_INPUT) {
+        return;
+    }
+    for (uint8_t client_num = 0; client_num < CLIENT_COUNT; client_num++) {
+        if ((client == client_num || client == CLIENT_ALL) && client_has_transport(client_num)) {
+            client_queue(client_num, data, len, status);
+        }
+    }
+}
+
+void client_write(uint8_t client, const char* text) {
+    client_write_queued(client, (const uint8_t*)text, strlen(text), false);
+}
+
+void client_write_status(uint8_t client, const char* text) {
+    client_write_queued(client, (const uint8_t*)text, strlen(text), true);
+}
+
+void client_write_status(uint8_t client, const uint8_t* data, size_t len) {
+    client_write_queued(client, data, len, true);
+}
+
+void client_flush_tx(uint32_t timeout_ms) {
+    uint32_t start = millis();
+    for (uint8_t client = 0; client < CLIENT_COUNT; client++) {
+        while ((client_tx[client].ring.available() || client_tx[client].status_len) && (millis() - start) < timeout_ms) {
+            vTaskDelay(1);
+        }
+    }
+}
+
+void client_report_tx_stats(uint8_t client) {
+    for (uint8_t client_num = 0; client_num < CLIENT_COUNT; client_num++) {
+        client_tx_t* tx = &client_tx[client_num];
+        if (tx->ring.size()) {
+            grbl_sendf(client,
+                       "[TX:%d,Queued:%d,HighWater:%d,Size:%d,Dropped:%d,Coalesced:%d]\r\n",
+                       client_num,
+                       tx->ring.available(),
+                       tx->high_water,
+                       tx->ring.size(),
+                       tx->dropped,
+                       tx->coalesced);
+        }
     }
 }
@@ -23,7 +23,27 @@
 #include "stdint.h"
 
 #ifndef RX_BUFFER_SIZE
-#    define RX_BUFFER_SIZE 256
+#    define RX_BUFFER_SIZE 1024
+#endif
+// Size of each client's ring of received lines. Must hold at least one full line.
+#ifndef CLIENT_RX_RING_SIZE
+#    define CLIENT_RX_RING_SIZE 1024
+#endif
+// How often the client task wakes to service WebUI, Bluetooth and restart requests
+// when no input arrives. With WiFi on it polls every tick, since sockets can't wake it.
+#ifndef CLIENT_IDLE_POLL_MS
+#    define CLIENT_IDLE_POLL_MS 50
+#endif
+// Size of each client's ring of output waiting for clientTxTask. A task that writes more
+// than fits waits for clientTxTask to make room, for a bounded time unless it is the
+// serial port; status reports and output from the realtime path are dropped.
+#ifndef CLIENT_TX_RING_SIZE
+#    define CLIENT_TX_RING_SIZE 2048
+#endif
+// How long a writer waits for room in the ring of a network or Bluetooth client before
+// it drops the output. The serial port is always waited for.
+#ifndef CLIENT_TX_WAIT_MS
+#    define CLIENT_TX_WAIT_MS 5
 #endif
 #ifndef TX_BUFFER_SIZE
 #    ifdef USE_LINE_NUMBERS
@@ -36,19 +56,36 @@
 // a task to read for incoming data from serial port
 void clientCheckTask(void* pvParameters);
 
+// a task to send queued output to each client
+void clientTxTask(void* pvParameters);
+
+// Queues text for a client and returns at once; clientTxTask does the actual sending
 void client_write(uint8_t client, const char* text);
 
-// Fetches the first byte in the serial read buffer. Called by main program.
-int client_read(uint8_t client);
+// Like client_write() for realtime status reports. Only the newest unsent report is kept.
+void client_write_status(uint8_t client, const char* text);
+void client_write_status(uint8_t client, const uint8_t* data, size_t len);
+
+// Waits up to timeout_ms for queued output to be sent, e.g. before a restart
+void client_flush_tx(uint32_t timeout_ms);
+
+// Reports the per-client output counters
+void client_report_tx_stats(uint8_t client);
+
+// Fetches the next complete line from a client. Called by main program.
+Error client_read_line(uint8_t client, char* line);
 
 // See if the character is an action command like feedhold or jogging. If so, do the action and return true
 uint8_t check_action_command(uint8_t data);
 
 void client_init();
+
+// Wakes the client task after input was queued by another task, e.g. a WebUI command
+void client_notify();
 void client_reset_read_buffer(uint8_t client);
 
 // Returns the number of bytes available in the RX serial buffer.
-uint8_t client_get_rx_buffer_available(uint8_t client);
+int client_get_rx_buffer_available(uint8_t client);
 
 void execute_realtime_command(Cmd command, uint8_t client);
 bool is_realtime_command(uint8_t data);
@@ -100,6 +100,7 @@ void Setting::init() {
         if (esp_err_t err = nvs_open("Grbl_ESP32", NVS_READWRITE, &_handle)) {
             grbl_sendf(CLIENT_SERIAL, "nvs_open failed with error %d\r\n", err);
         }
+        nvs_cache_init();
     }
 }
 
@@ -109,7 +110,7 @@ IntSetting::IntSetting(const char* description, type_t type, permissions_t permi
 }
 
 void IntSetting::load() {
-    esp_err_t err = nvs_get_i32(_handle, _keyName, &_storedValue);
+    esp_err_t err = snapshot_get_i32(_handle, _keyName, &_storedValue);
     if (err) {
         _storedValue  = std::numeric_limits<int32_t>::min();
         _currentValue = _defaultValue;
@@ -120,11 +121,11 @@ void IntSetting::load() {
 
 void IntSetting::setDefault() {
     if (_currentIsNvm) {
-        nvs_erase_key(_handle, _keyName);
+        nvs_cache_erase_key(_handle, _keyName);
     } else {
         _currentValue = _defaultValue;
         if (_storedValue != _currentValue) {
-            nvs_erase_key(_handle, _keyName);
+            nvs_cache_erase_key(_handle, _keyName);
         }
     }
 }
@@ -151,9 +152,9 @@ Error IntSetting::setStringValue(char* s) {
 
     if (_storedValue != convertedValue) {
         if (convertedValue == _defaultValue) {
-            nvs_erase_key(_handle, _keyName);
+            nvs_cache_erase_key(_handle, _keyName);
         } else {
-            if (nvs_set_i32(_handle, _keyName, convertedValue)) {
+            if (nvs_cache_set_i32(_handle, _keyName, convertedValue)) {
                 return Error::NvsSetFailed;
             }
             _storedValue = convertedValue;
@@ -184,9 +185,9 @@ Error IntSetting::setValue(int32_t value) {
 
     if (_storedValue != convertedValue) {
         if (convertedValue == _defaultValue) {
-            nvs_erase_key(_handle, _keyName);
+            nvs_cache_erase_key(_handle, _keyName);
         } else {
-            if (nvs_set_i32(_handle, _keyName, convertedValue)) {
+            if (nvs_cache_set_i32(_handle, _keyName, convertedValue)) {
                 return Error::NvsSetFailed;
             }
             _storedValue = convertedValue;
@@ -231,7 +232,7 @@ AxisMaskSetting::AxisMaskSetting(const char* description, type_t type, permissio
     Setting(description, type, permissions, grblName, name, checker), _defaultValue(defVal), _currentValue(defVal) {}
 
 void AxisMaskSetting::load() {
-    esp_err_t err = nvs_get_i32(_handle, _keyName, &_storedValue);
+    esp_err_t err = snapshot_get_i32(_handle, _keyName, &_storedValue);
     if (err) {
         _storedValue  = -1;
         _currentValue = _defaultValue;
@@ -243,16 +244,16 @@ void AxisMaskSetting::load() {
 void AxisMaskSetting::setDefault() {
     _currentValue = _defaultValue;
     if (_storedValue != _currentValue) {
-        nvs_erase_key(_handle, _keyName);
+        nvs_cache_erase_key(_handle, _keyName);
     }
 }
 
 Error AxisMaskSetting::saveValue() {
     if (_storedValue != _currentValue) {
         if (_currentValue == _defaultValue) {
-            nvs_erase_key(_handle, _keyName);
+            nvs_cache_erase_key(_handle, _keyName);
         } else {
-            if (nvs_set_i32(_handle, _keyName, _currentValue)) {
+            if (nvs_cache_set_i32(_handle, _keyName, _currentValue)) {
                 return Error::NvsSetFailed;
             }
             _storedValue = _currentValue;
@@ -301,9 +302,9 @@ Error AxisMaskSetting::setStringValue(char* s) {
     _currentValue = convertedValue;
     if (_storedValue != _currentValue) {
         if (_currentValue == _defaultValue) {
-            nvs_erase_key(_handle, _keyName);
+            nvs_cache_erase_key(_handle, _keyName);
         } else {
-            if (nvs_set_i32(_handle, _keyName, _currentValue)) {
+            if (nvs_cache_set_i32(_handle, _keyName, _currentValue)) {
                 return Error::NvsSetFailed;
             }
             _storedValue = _currentValue;
@@ -355,7 +356,7 @@ void FloatSetting::load() {
         int32_t ival;
         float   fval;
     } v;
-    if (nvs_get_i32(_handle, _keyName, &v.ival)) {
+    if (snapshot_get_i32(_handle, _keyName, &v.ival)) {
         _currentValue = _defaultValue;
     } else {
         _currentValue = v.fval;
@@ -365,7 +366,7 @@ void FloatSetting::load() {
 void FloatSetting::setDefault() {
     _currentValue = _defaultValue;
     if (_storedValue != _currentValue) {
-        nvs_erase_key(_handle, _keyName);
+        nvs_cache_erase_key(_handle, _keyName);
     }
 }
 
@@ -388,14 +389,14 @@ Error FloatSetting::setStringValue(char* s) {
     _currentValue = convertedValue;
     if (_storedValue != _currentValue) {
         if (_currentValue == _defaultValue) {
-            nvs_erase_key(_handle, _keyName);
+            nvs_cache_erase_key(_handle, _keyName);
         } else {
             union {
                 int32_t ival;
                 float   fval;
             } v;
             v.fval = _currentValue;
-            if (nvs_set_i32(_handle, _keyName, v.ival)) {
+            if (nvs_cache_set_i32(_handle, _keyName, v.ival)) {
                 return Error::NvsSetFailed;
             }
             _storedValue = _currentValue;
@@ -421,14 +422,14 @@ Error FloatSetting::setValue(float value) {
     _currentValue = convertedValue;
     if (_storedValue != _currentValue) {
         if (_currentValue == _defaultValue) {
-            nvs_erase_key(_handle, _keyName);
+            nvs_cache_erase_key(_handle, _keyName);
         } else {
             union {
                 int32_t ival;
                 float   fval;
             } v;
             v.fval = _currentValue;
-            if (nvs_set_i32(_handle, _keyName, v.ival)) {
+            if (nvs_cache_set_i32(_handle, _keyName, v.ival)) {
                 return Error::NvsSetFailed;
             }
             _storedValue = _currentValue;
@@ -472,14 +473,14 @@ StringSetting::StringSetting(const char* description, type_t type, permissions_t
 
 void StringSetting::load() {
     size_t    len = 0;
-    esp_err_t err = nvs_get_str(_handle, _keyName, NULL, &len);
+    esp_err_t err = snapshot_get_str(_handle, _keyName, NULL, &len);
     if (err) {
         _storedValue  = _defaultValue;
         _currentValue = _defaultValue;
         return;
     }
     char buf[len];
-    err = nvs_get_str(_handle, _keyName, buf, &len);
+    err = snapshot_get_str(_handle, _keyName, buf, &len);
     if (err) {
         _storedValue  = _defaultValue;
         _currentValue = _defaultValue;
@@ -492,7 +493,7 @@ void StringSetting::load() {
 void StringSetting::setDefault() {
     _currentValue = _defaultValue;
     if (_storedValue != _currentValue) {
-        nvs_erase_key(_handle, _keyName);
+        nvs_cache_erase_key(_handle, _keyName);
     }
 }
 
@@ -507,10 +508,10 @@ Error StringSetting::setStringValue(char* s) {
     _currentValue = s;
     if (_storedValue != _currentValue) {
         if (_currentValue == _defaultValue) {
-            nvs_erase_key(_handle, _keyName);
+            nvs_cache_erase_key(_handle, _keyName);
             _storedValue = _defaultValue;
         } else {
-            if (nvs_set_str(_handle, _keyName, _currentValue.c_str())) {
+            if (nvs_cache_set_str(_handle, _keyName, _currentValue.c_str())) {
                 return Error::NvsSetFailed;
             }
             _storedValue = _currentValue;
@@ -551,7 +552,7 @@ EnumSetting::EnumSetting(const char* description, type_t type, permissions_t per
     Setting(description, type, permissions, grblName, name, checker), _defaultValue(defVal), _options(opts) {}
 
 void EnumSetting::load() {
-    esp_err_t err = nvs_get_i8(_handle, _keyName, &_storedValue);
+    esp_err_t err = snapshot_get_i8(_handle, _keyName, &_storedValue);
     if (err) {
         _storedValue  = -1;
         _currentValue = _defaultValue;
@@ -563,7 +564,7 @@ void EnumSetting::load() {
 void EnumSetting::setDefault() {
     _currentValue = _defaultValue;
     if (_storedValue != _currentValue) {
-        nvs_erase_key(_handle, _keyName);
+        nvs_cache_erase_key(_handle, _keyName);
     }
 }
 
@@ -630,9 +631,9 @@ Error EnumSetting::setStringValue(char* s) {
     _currentValue = it->second;
     if (_storedValue != _currentValue) {
         if (_currentValue == _defaultValue) {
-            nvs_erase_key(_handle, _keyName);
+            nvs_cache_erase_key(_handle, _keyName);
         } else {
-            if (nvs_set_i8(_handle, _keyName, _currentValue)) {
+            if (nvs_cache_set_i8(_handle, _keyName, _currentValue)) {
                 return Error::NvsSetFailed;
             }
             _storedValue = _currentValue;
@@ -662,9 +663,9 @@ Error EnumSetting::setEnumValue(int8_t value) {
     }
     if (_storedValue != _currentValue) {
         if (_currentValue == _defaultValue) {
-            nvs_erase_key(_handle, _keyName);
+            nvs_cache_erase_key(_handle, _keyName);
         } else {
-            if (nvs_set_i8(_handle, _keyName, _currentValue)) {
+            if (nvs_cache_set_i8(_handle, _keyName, _currentValue)) {
                 return Error::NvsSetFailed;
             }
             _storedValue = _currentValue;
@@ -708,7 +709,7 @@ FlagSetting::FlagSetting(const char* description, type_t type, permissions_t per
     Setting(description, type, permissions, grblName, name, checker), _defaultValue(defVal) {}
 
 void FlagSetting::load() {
-    esp_err_t err = nvs_get_i8(_handle, _keyName, &_storedValue);
+    esp_err_t err = snapshot_get_i8(_handle, _keyName, &_storedValue);
     if (err) {
         _storedValue  = -1;  // Neither well-formed false (0) nor true (1)
         _currentValue = _defaultValue;
@@ -719,7 +720,7 @@ void FlagSetting::load() {
 void FlagSetting::setDefault() {
     _currentValue = _defaultValue;
     if (_storedValue != _currentValue) {
-        nvs_erase_key(_handle, _keyName);
+        nvs_cache_erase_key(_handle, _keyName);
     }
 }
 
@@ -737,9 +738,9 @@ Error FlagSetting::setBoolValue(bool value) {
     // _currentValue is 0 or 1
     if (_storedValue != (int8_t)_currentValue) {
         if (_currentValue == _defaultValue) {
-            nvs_erase_key(_handle, _keyName);
+            nvs_cache_erase_key(_handle, _keyName);
         } else {
-            if (nvs_set_i8(_handle, _keyName, _currentValue)) {
+            if (nvs_cache_set_i8(_handle, _keyName, _currentValue)) {
                 return Error::NvsSetFailed;
             }
             _storedValue = _currentValue;
@@ -760,9 +761,9 @@ Error FlagSetting::setStringValue(char* s) {
     // _currentValue is 0 or 1
     if (_storedValue != (int8_t)_currentValue) {
         if (_currentValue == _defaultValue) {
-            nvs_erase_key(_handle, _keyName);
+            nvs_cache_erase_key(_handle, _keyName);
         } else {
-            if (nvs_set_i8(_handle, _keyName, _currentValue)) {
+            if (nvs_cache_set_i8(_handle, _keyName, _currentValue)) {
                 return Error::NvsSetFailed;
             }
             _storedValue = _currentValue;
@@ -800,7 +801,7 @@ IPaddrSetting::IPaddrSetting(const char* description, type_t type, permissions_t
 }
 
 void IPaddrSetting::load() {
-    esp_err_t err = nvs_get_i32(_handle, _keyName, (int32_t*)&_storedValue);
+    esp_err_t err = snapshot_get_i32(_handle, _keyName, (int32_t*)&_storedValue);
     if (err) {
         _storedValue  = 0x000000ff;  // Unreasonable value for any IP thing
         _currentValue = _defaultValue;
@@ -812,7 +813,7 @@ void IPaddrSetting::load() {
 void IPaddrSetting::setDefault() {
     _currentValue = _defaultValue;
     if (_storedValue != _currentValue) {
-        nvs_erase_key(_handle, _keyName);
+        nvs_cache_erase_key(_handle, _keyName);
     }
 }
 
@@ -829,9 +830,9 @@ Error IPaddrSetting::setStringValue(char* s) {
     _currentValue = ipaddr;
     if (_storedValue != _currentValue) {
         if (_currentValue == _defaultValue) {
-            nvs_erase_key(_handle, _keyName);
+            nvs_cache_erase_key(_handle, _keyName);
         } else {
-            if (nvs_set_i32(_handle, _keyName, (int32_t)_currentValue)) {
+            if (nvs_cache_set_i32(_handle, _keyName, (int32_t)_currentValue)) {
                 return Error::NvsSetFailed;
             }
             _storedValue = _currentValue;
@@ -871,8 +872,8 @@ Error GrblCommand::action(char* value, WebUI::AuthenticationLevel auth_level, We
 Coordinates* coords[CoordIndex::End];
 
 bool Coordinates::load() {
-    size_t    len;
-    esp_err_t test = nvs_get_blob(Setting::_handle, _name, _currentValue, &len);
+    size_t    len  = sizeof(_currentValue);
+    esp_err_t test = snapshot_get_blob(Setting::_handle, _name, _currentValue, &len);
     switch (test) {
         case ESP_OK:
             return true;
@@ -893,10 +894,7 @@ bool Coordinates::load() {
 
 void Coordinates::set(float value[MAX_N_AXIS]) {
     memcpy(&_currentValue, value, sizeof(_currentValue));
-#ifdef FORCE_BUFFER_SYNC_DURING_NVS_WRITE
-    protocol_buffer_synchronize();
-#endif
-    nvs_set_blob(Setting::_handle, _name, _currentValue, sizeof(_currentValue));
+    nvs_cache_set_blob(Setting::_handle, _name, _currentValue, sizeof(_currentValue));
 }
 
 ToolTable_t* ToolTable;  //= new ToolTable_t();
@@ -906,7 +904,8 @@ bool ToolTable_t::load() {
     size_t  len;
 
     // load active
-    switch (nvs_get_blob(Setting::_handle, name_act, &_tool_active, &len)) {
+    len = sizeof(_tool_active);
+    switch (snapshot_get_blob(Setting::_handle, name_act, &_tool_active, &len)) {
         case ESP_OK:
         case ESP_ERR_NVS_INVALID_LENGTH:
             // This could happen if the stored value is longer than the buffer.
@@ -925,7 +924,8 @@ bool ToolTable_t::load() {
     }
 
     // load selected
-    switch (nvs_get_blob(Setting::_handle, name_sel, &_tool_selected, &len)) {
+    len = sizeof(_tool_selected);
+    switch (snapshot_get_blob(Setting::_handle, name_sel, &_tool_selected, &len)) {
         case ESP_OK:
         case ESP_ERR_NVS_INVALID_LENGTH:
             // This could happen if the stored value is longer than the buffer.
@@ -963,20 +963,14 @@ bool ToolTable_t::load() {
 void ToolTable_t::set_tool_active(uint8_t value) {
     if (_isinit) {
         _tool_active = value;
-#ifdef FORCE_BUFFER_SYNC_DURING_NVS_WRITE
-        protocol_buffer_synchronize();
-#endif
-        nvs_set_blob(Setting::_handle, name_act, &_tool_active, sizeof(_tool_active));
+        nvs_cache_set_blob(Setting::_handle, name_act, &_tool_active, sizeof(_tool_active));
     }
 }
 
 void ToolTable_t::set_tool_selected(uint8_t value) {
     if (_isinit) {
         _tool_selected = value;
-#ifdef FORCE_BUFFER_SYNC_DURING_NVS_WRITE
-        protocol_buffer_synchronize();
-#endif
-        nvs_set_blob(Setting::_handle, name_sel, &_tool_selected, sizeof(_tool_selected));
+        nvs_cache_set_blob(Setting::_handle, name_sel, &_tool_selected, sizeof(_tool_selected));
     }
 }
 
@@ -987,7 +981,8 @@ bool ToolNfo::load() {
 
     // load xyz
     snprintf(_temp, sizeof(_temp), "%s_xyz", _name);
-    switch (nvs_get_blob(Setting::_handle, _temp, _xyz, &len)) {
+    len = sizeof(_xyz);
+    switch (snapshot_get_blob(Setting::_handle, _temp, _xyz, &len)) {
         case ESP_OK:
             bit_true(load_mask, bit(0));
             break;
@@ -1009,7 +1004,8 @@ bool ToolNfo::load() {
     if (bit_isfalse(load_mask, bit(0))) {
         for (int idx = 0; idx < MAX_N_AXIS; idx++) {
             snprintf(_temp, sizeof(_temp), "%s_xyz_%d", _name, idx);
-            switch (nvs_get_blob(Setting::_handle, _temp, &_xyz[idx], &len)) {
+            len = sizeof(_xyz[idx]);
+            switch (snapshot_get_blob(Setting::_handle, _temp, &_xyz[idx], &len)) {
                 case ESP_OK:
                 case ESP_ERR_NVS_INVALID_LENGTH:
                     // This could happen if the stored value is longer than the buffer.
@@ -1034,7 +1030,8 @@ bool ToolNfo::load() {
 
     // load i
     snprintf(_temp, sizeof(_temp), "%s_i", _name);
-    switch (nvs_get_blob(Setting::_handle, _temp, &_i, &len)) {
+    len = sizeof(_i);
+    switch (snapshot_get_blob(Setting::_handle, _temp, &_i, &len)) {
         case ESP_OK:
         case ESP_ERR_NVS_INVALID_LENGTH:
             // This could happen if the stored value is longer than the buffer.
@@ -1054,7 +1051,8 @@ bool ToolNfo::load() {
 
     // load j
     snprintf(_temp, sizeof(_temp), "%s_j", _name);
-    switch (nvs_get_blob(Setting::_handle, _temp, &_j, &len)) {
+    len = sizeof(_j);
+    switch (snapshot_get_blob(Setting::_handle, _temp, &_j, &len)) {
         case ESP_OK:
         case ESP_ERR_NVS_INVALID_LENGTH:
             // This could happen if the stored value is longer than the buffer.
@@ -1074,7 +1072,8 @@ bool ToolNfo::load() {
 
     // load p
     snprintf(_temp, sizeof(_temp), "%s_p", _name);
-    switch (nvs_get_blob(Setting::_handle, _temp, &_p, &len)) {
+    len = sizeof(_p);
+    switch (snapshot_get_blob(Setting::_handle, _temp, &_p, &len)) {
         case ESP_OK:
         case ESP_ERR_NVS_INVALID_LENGTH:
             // This could happen if the stored value is longer than the buffer.
@@ -1094,7 +1093,8 @@ bool ToolNfo::load() {
 
     // load r
     snprintf(_temp, sizeof(_temp), "%s_r", _name);
-    switch (nvs_get_blob(Setting::_handle, _temp, &_r, &len)) {
+    len = sizeof(_r);
+    switch (snapshot_get_blob(Setting::_handle, _temp, &_r, &len)) {
         case ESP_OK:
         case ESP_ERR_NVS_INVALID_LENGTH:
             // This could happen if the stored value is longer than the buffer.
@@ -1114,7 +1114,8 @@ bool ToolNfo::load() {
 
     // load q
     snprintf(_temp, sizeof(_temp), "%s_q", _name);
-    switch (nvs_get_blob(Setting::_handle, _temp, &_q, &len)) {
+    len = sizeof(_q);
+    switch (snapshot_get_blob(Setting::_handle, _temp, &_q, &len)) {
         case ESP_OK:
         case ESP_ERR_NVS_INVALID_LENGTH:
             // This could happen if the stored value is longer than the buffer.
@@ -1144,71 +1145,53 @@ bool ToolNfo::load() {
 void ToolNfo::set_i(float value) {
     if (_isinit) {
         _i = value;
-#ifdef FORCE_BUFFER_SYNC_DURING_NVS_WRITE
-        protocol_buffer_synchronize();
-#endif
         snprintf(_temp, sizeof(_temp), "%s_i", _name);
-        nvs_set_blob(Setting::_handle, _temp, &_i, sizeof(_i));
+        nvs_cache_set_blob(Setting::_handle, _temp, &_i, sizeof(_i));
     }
 }
 
 void ToolNfo::set_j(float value) {
     if (_isinit) {
         _j = value;
-#ifdef FORCE_BUFFER_SYNC_DURING_NVS_WRITE
-        protocol_buffer_synchronize();
-#endif
         snprintf(_temp, sizeof(_temp), "%s_j", _name);
-        nvs_set_blob(Setting::_handle, _temp, &_j, sizeof(_j));
+        nvs_cache_set_blob(Setting::_handle, _temp, &_j, sizeof(_j));
     }
 }
 
 void ToolNfo::set_p(float value) {
     if (_isinit) {
         _p = value;
-#ifdef FORCE_BUFFER_SYNC_DURING_NVS_WRITE
-        protocol_buffer_synchronize();
-#endif
         snprintf(_temp, sizeof(_temp), "%s_p", _name);
-        nvs_set_blob(Setting::_handle, _temp, &_p, sizeof(_p));
+        nvs_cache_set_blob(Setting::_handle, _temp, &_p, sizeof(_p));
     }
 }
 
 void ToolNfo::set_q(float value) {
     if (_isinit) {
         _q = value;
-#ifdef FORCE_BUFFER_SYNC_DURING_NVS_WRITE
-        protocol_buffer_synchronize();
-#endif
         snprintf(_temp, sizeof(_temp), "%s_q", _name);
-        nvs_set_blob(Setting::_handle, _temp, &_q, sizeof(_q));
+        nvs_cache_set_blob(Setting::_handle, _temp, &_q, sizeof(_q));
     }
 }
 
 void ToolNfo::set_r(float value) {
     if (_isinit) {
         _r = value;
-#ifdef FORCE_BUFFER_SYNC_DURING_NVS_WRITE
-        protocol_buffer_synchronize();
-#endif
         snprintf(_temp, sizeof(_temp), "%s_r", _name);
-        nvs_set_blob(Setting::_handle, _temp, &_r, sizeof(_r));
+        nvs_cache_set_blob(Setting::_handle, _temp, &_r, sizeof(_r));
     }
 }
 
 void ToolNfo::set_xyz(float value[MAX_N_AXIS]) {
     if (_isinit) {
         memcpy(&_xyz, value, sizeof(_xyz));
-#ifdef FORCE_BUFFER_SYNC_DURING_NVS_WRITE
-        protocol_buffer_synchronize();
-#endif
         snprintf(_temp, sizeof(_temp), "%s_xyz", _name);
 
-        nvs_set_blob(Setting::_handle, _temp, _xyz, sizeof(_xyz));
+        nvs_cache_set_blob(Setting::_handle, _temp, _xyz, sizeof(_xyz));
 
         for (int idx = 0; idx < MAX_N_AXIS; idx++) {
             snprintf(_temp, sizeof(_temp), "%s_xyz_%d", _name, idx);
-            nvs_set_blob(Setting::_handle, _temp, &_xyz[idx], sizeof(float));
+            nvs_cache_set_blob(Setting::_handle, _temp, &_xyz[idx], sizeof(float));
         }
     }
 }
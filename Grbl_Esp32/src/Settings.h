@@ -109,6 +109,7 @@ public:
     static void       init();
     static Setting*   List;
     Setting*          next() { return link; }
+    const char*       getKeyName() { return _keyName; }
 
     Error _checkError = Error::Ok;  // DO NOT use unless you are absolutely certain of its purpose and implications.
 
@@ -119,7 +120,12 @@ public:
         if (esp_err_t err = nvs_get_stats(NULL, &stats)) {
             return Error::NvsGetStatsFailed;
         }
-        grbl_sendf(out->client(), "[MSG: NVS Used: %d Free: %d Total: %d]\r\n", stats.used_entries, stats.free_entries, stats.total_entries);
+        grbl_sendf(out->client(),
+                   "[MSG: NVS Used: %d Free: %d Total: %d Pending: %d]\r\n",
+                   stats.used_entries,
+                   stats.free_entries,
+                   stats.total_entries,
+                   nvs_cache_pending());
 #if 0  // The SDK we use does not have this yet
         nvs_iterator_t it = nvs_entry_find(NULL, NULL, NVS_TYPE_ANY);
         while (it != NULL) {
@@ -133,6 +139,8 @@ public:
     }
 
     static Error eraseNVS(const char* value, WebUI::AuthenticationLevel auth_level, WebUI::ESPResponseStream* out) {
+        nvs_cache_clear();
+        snapshot_clear();
         nvs_erase_all(_handle);
         return Error::Ok;
     }
@@ -301,6 +309,7 @@ private:
 
 public:
     ToolTable_t() : _tool_active(0), _tool_selected(0) {
+        nvs_cache_write_through(name_act);
         for (uint8_t idx = 0; idx < MAX_TOOL_NUMBER; idx++) {
             _tools[idx] = new ToolNfo(idx + 1);
         }
@@ -1,7 +1,11 @@
 #include "Grbl.h"
+#include "Spindles/PWMSpindle.h"
 
 FlagSetting* verbose_errors;
 
+IntSetting* stream_ack_lines;
+IntSetting* stream_ack_ms;
+
 FakeSetting<int>* number_axis;
 
 StringSetting* startup_line_0;
@@ -35,6 +39,7 @@ FlagSetting* homing_enable;
 FlagSetting* laser_mode;
 // TODO Settings - also need to call my_spindle->init;
 IntSetting* laser_full_power;
+IntSetting* laser_power_updates;
 
 IntSetting*   status_mask;
 FloatSetting* junction_deviation;
@@ -61,6 +66,10 @@ FloatSetting*    rpm_max;
 FloatSetting*    rpm_min;
 FloatSetting*    spindle_delay_spinup;
 FloatSetting*    spindle_delay_spindown;
+FloatSetting*    spindle_ramp_up;
+FloatSetting*    spindle_ramp_down;
+FloatSetting*    spindle_at_speed_tolerance;
+FloatSetting*    spindle_at_speed_timeout;
 FloatSetting*    coolant_start_delay;
 FlagSetting*     spindle_enbl_off_with_zero_speed;
 FlagSetting*     spindle_enable_invert;
@@ -78,6 +87,8 @@ FloatSetting* spindle_pwm_min_value;
 FloatSetting* spindle_pwm_max_value;
 IntSetting*   spindle_pwm_bit_precision;
 
+StringSetting* spindle_pwm_map;
+
 EnumSetting* spindle_type;
 
 FlagSetting*  atc_connected;
@@ -181,6 +192,13 @@ static bool postMotorSetting(char* value) {
     return true;
 }
 
+static bool postMotionSetting(char* value) {
+    if (!value) {
+        motion_config_update();
+    }
+    return true;
+}
+
 static bool checkATCChange(char* value) {
     // TODO Check for errors
     atc_connected->_checkError = Error::Ok;
@@ -278,6 +296,22 @@ static bool checkSpindleChange(char* val) {
     return true;
 }
 
+// M100-M102 store the type after they have switched to it
+static bool checkSpindleType(char* val) {
+    if (!val && spindle == Spindles::Spindle::find(static_cast<SpindleType>(spindle_type->get()))) {
+        return true;
+    }
+    return checkSpindleChange(val);
+}
+
+static bool checkSpindleMap(char* val) {
+    if (!val) {
+        return checkSpindleChange(val);
+    }
+    Spindles::PWM::MapPoint points[SPINDLE_PWM_MAP_POINTS];
+    return Spindles::PWM::parse_map(val, points) >= 0;
+}
+
 // Generates a string like "122" from axisNum 2 and base 120
 static const char* makeGrblName(int axisNum, int base) {
     // To omit A,B,C axes:
@@ -292,6 +326,7 @@ void make_coordinate(CoordIndex index, const char* name) {
     float coord_data[MAX_N_AXIS] = { 0.0 };
     auto  coord                  = new Coordinates(name);
     coords[index]                = coord;
+    nvs_cache_write_through(name);  // Offsets must survive a power loss during a job
     if (!coord->load()) {
         coords[index]->setDefault();
     }
@@ -321,6 +356,9 @@ void make_settings() {
 
     verbose_errors = new FlagSetting(EXTENDED, WG, NULL, "Errors/Verbose", DEFAULT_VERBOSE_ERRORS);
 
+    stream_ack_lines = new IntSetting(EXTENDED, WG, NULL, "Stream/AckLines", DEFAULT_STREAM_ACK_LINES, 1, 1000);
+    stream_ack_ms    = new IntSetting(EXTENDED, WG, NULL, "Stream/AckMs", DEFAULT_STREAM_ACK_MS, 1, 10000);
+
     // number_axis = new IntSetting(EXTENDED, WG, NULL, "NumberAxis", N_AXIS, 0, 6, NULL, true);
     number_axis = new FakeSetting<int>(N_AXIS);
 
@@ -378,19 +416,19 @@ void make_settings() {
 
     for (axis = MAX_N_AXIS - 1; axis >= 0; axis--) {
         def          = &axis_defaults[axis];
-        auto setting = new FloatSetting(GRBL, WG, makeGrblName(axis, 120), makename(def->name, "Acceleration"), def->acceleration, 1.0, 100000.0);
+        auto setting = new FloatSetting(GRBL, WG, makeGrblName(axis, 120), makename(def->name, "Acceleration"), def->acceleration, 1.0, 100000.0, postMotionSetting);
         setting->setAxis(axis);
         axis_settings[axis]->acceleration = setting;
     }
     for (axis = MAX_N_AXIS - 1; axis >= 0; axis--) {
         def          = &axis_defaults[axis];
-        auto setting = new FloatSetting(GRBL, WG, makeGrblName(axis, 110), makename(def->name, "MaxRate"), def->max_rate, 1.0, 1000000.0);
+        auto setting = new FloatSetting(GRBL, WG, makeGrblName(axis, 110), makename(def->name, "MaxRate"), def->max_rate, 1.0, 1000000.0, postMotionSetting);
         setting->setAxis(axis);
         axis_settings[axis]->max_rate = setting;
     }
     for (axis = MAX_N_AXIS - 1; axis >= 0; axis--) {
         def          = &axis_defaults[axis];
-        auto setting = new FloatSetting(GRBL, WG, makeGrblName(axis, 100), makename(def->name, "StepsPerMm"), def->steps_per_mm, 1.0, 100000.0);
+        auto setting = new FloatSetting(GRBL, WG, makeGrblName(axis, 100), makename(def->name, "StepsPerMm"), def->steps_per_mm, 1.0, 100000.0, postMotionSetting);
         setting->setAxis(axis);
         axis_settings[axis]->steps_per_mm = setting;
     }
@@ -406,6 +444,7 @@ void make_settings() {
     tool_selected = new IntSetting(EXTENDED, WG, "62", "Tool/Selected", 1, 1, DEFAULT_TOOL_COUNT_MAX, NULL);
     tool_active   = new IntSetting(EXTENDED, WG, "61", "Tool/Active", 1, 1, DEFAULT_TOOL_COUNT_MAX, NULL);
     tool_count    = new IntSetting(EXTENDED, WG, "60", "Tool/Count", DEFAULT_TOOL_COUNT_MAX, 1, DEFAULT_TOOL_COUNT_MAX, NULL);
+    nvs_cache_write_through(tool_active->getKeyName());  // The tool in the spindle must survive a power loss
 
     // Limit move vars
 
@@ -443,17 +482,23 @@ void make_settings() {
 
     spindle_enable_invert = new FlagSetting(EXTENDED, WG, "38", "Spindle/Enable/Invert", DEFAULT_INVERT_SPINDLE_ENABLE_PIN, checkSpindleChange);
 
-    spindle_type = new EnumSetting(NULL, EXTENDED, WG, "37", "Spindle/Type", static_cast<int8_t>(SPINDLE_TYPE), &spindleTypes, checkSpindleChange);
+    spindle_type = new EnumSetting(NULL, EXTENDED, WG, "37", "Spindle/Type", static_cast<int8_t>(SPINDLE_TYPE), &spindleTypes, checkSpindleType);
 
     spindle_pwm_max_value = new FloatSetting(EXTENDED, WG, "36", "Spindle/PWM/Max", DEFAULT_SPINDLE_MAX_VALUE, 0.0, 100.0, checkSpindleChange);
     spindle_pwm_min_value = new FloatSetting(EXTENDED, WG, "35", "Spindle/PWM/Min", DEFAULT_SPINDLE_MIN_VALUE, 0.0, 100.0, checkSpindleChange);
     spindle_pwm_off_value = new FloatSetting(EXTENDED, WG, "34", "Spindle/PWM/Off", DEFAULT_SPINDLE_OFF_VALUE, 0.0, 100.0, checkSpindleChange);  // these are percentages
     // IntSetting spindle_pwm_bit_precision(EXTENDED, WG, "Spindle/PWM/Precision", DEFAULT_SPINDLE_BIT_PRECISION, 1, 16);
     spindle_pwm_freq = new FloatSetting(EXTENDED, WG, "33", "Spindle/PWM/Frequency", DEFAULT_SPINDLE_FREQ, 0, 100000, checkSpindleChange);
+    spindle_pwm_map  = new StringSetting(EXTENDED, WG, NULL, "Spindle/PWM/Map", DEFAULT_SPINDLE_PWM_MAP, checkSpindleMap);
 
     spindle_delay_spinup   = new FloatSetting(EXTENDED, WG, NULL, "Spindle/Delay/SpinUp", DEFAULT_SPINDLE_DELAY_SPINUP, 0, 30, checkSpindleChange);
     spindle_delay_spindown = new FloatSetting(EXTENDED, WG, NULL, "Spindle/Delay/SpinDown", DEFAULT_SPINDLE_DELAY_SPINUP, 0, 30, checkSpindleChange);
     coolant_start_delay    = new FloatSetting(EXTENDED, WG, NULL, "Coolant/Delay/TurnOn", DEFAULT_COOLANT_DELAY_TURNON, 0, 30);
+    spindle_ramp_up        = new FloatSetting(EXTENDED, WG, NULL, "Spindle/Ramp/Up", DEFAULT_SPINDLE_RAMP_UP, 0, 60, checkSpindleChange);
+    spindle_ramp_down      = new FloatSetting(EXTENDED, WG, NULL, "Spindle/Ramp/Down", DEFAULT_SPINDLE_RAMP_DOWN, 0, 60, checkSpindleChange);
+
+    spindle_at_speed_tolerance = new FloatSetting(EXTENDED, WG, NULL, "Spindle/AtSpeed/Tolerance", DEFAULT_SPINDLE_AT_SPEED_TOLERANCE, 0, 50);
+    spindle_at_speed_timeout   = new FloatSetting(EXTENDED, WG, NULL, "Spindle/AtSpeed/Timeout", DEFAULT_SPINDLE_AT_SPEED_TIMEOUT, 0.5, 120);
 
     spindle_enbl_off_with_zero_speed = new FlagSetting(GRBL, WG, NULL, "Spindle/Enable/OffWithSpeed", DEFAULT_SPINDLE_ENABLE_OFF_WITH_ZERO_SPEED, checkSpindleChange);
 
@@ -466,6 +511,8 @@ void make_settings() {
     rpm_max_chuck    = new FloatSetting(EXTENDED, WG, "29", "Chuck/MaxS", DEFAULT_CHUCK_RPM_MAX, 0, 100000, checkSpindleChange);
     laser_full_power = new IntSetting(EXTENDED, WG, "28", "Laser/FullPower", DEFAULT_LASER_FULL_POWER, 0, 10000, checkSpindleChange);
 
+    laser_power_updates = new IntSetting(EXTENDED, WG, NULL, "Laser/PowerUpdates", DEFAULT_LASER_POWER_UPDATES, 1, 64, postMotionSetting);
+
     // GRBL Non-numbered settings
     startup_line_1 = new StringSetting(EXTENDED, WG, "N1", "GCode/Line1", "", checkStartupLine);
     startup_line_0 = new StringSetting(EXTENDED, WG, "N0", "GCode/Line0", "", checkStartupLine);
@@ -489,7 +536,7 @@ void make_settings() {
     report_inches = new FlagSetting(GRBL, WG, "13", "Report/Inches", DEFAULT_REPORT_INCHES);
     // TODO Settings - also need to clear, but not set, soft_limits
     arc_tolerance      = new FloatSetting(GRBL, WG, "12", "GCode/ArcTolerance", DEFAULT_ARC_TOLERANCE, 0, 1);
-    junction_deviation = new FloatSetting(GRBL, WG, "11", "GCode/JunctionDeviation", DEFAULT_JUNCTION_DEVIATION, 0, 10);
+    junction_deviation = new FloatSetting(GRBL, WG, "11", "GCode/JunctionDeviation", DEFAULT_JUNCTION_DEVIATION, 0, 10, postMotionSetting);
     status_mask        = new IntSetting(GRBL, WG, "10", "Report/Status", DEFAULT_STATUS_REPORT_MASK, 0, 3);
 
     probe_invert                 = new FlagSetting(GRBL, WG, "6", "Probe/Invert", DEFAULT_INVERT_PROBE_PIN);
@@ -498,8 +545,8 @@ void make_settings() {
     dir_invert_mask              = new AxisMaskSetting(GRBL, WG, "3", "Stepper/DirInvert", DEFAULT_DIRECTION_INVERT_MASK, postMotorSetting);
     step_invert_mask             = new AxisMaskSetting(GRBL, WG, "2", "Stepper/StepInvert", DEFAULT_STEPPING_INVERT_MASK, postMotorSetting);
     stepper_idle_lock_time       = new IntSetting(GRBL, WG, "1", "Stepper/IdleTime", DEFAULT_STEPPER_IDLE_LOCK_TIME, 0, 255);
-    pulse_microseconds           = new IntSetting(GRBL, WG, "0", "Stepper/Pulse", DEFAULT_STEP_PULSE_MICROSECONDS, 3, 1000);
-    direction_delay_microseconds = new IntSetting(EXTENDED, WG, NULL, "Stepper/Direction/Delay", STEP_PULSE_DELAY, 0, 1000);
+    pulse_microseconds           = new IntSetting(GRBL, WG, "0", "Stepper/Pulse", DEFAULT_STEP_PULSE_MICROSECONDS, 3, 1000, postMotionSetting);
+    direction_delay_microseconds = new IntSetting(EXTENDED, WG, NULL, "Stepper/Direction/Delay", STEP_PULSE_DELAY, 0, 1000, postMotionSetting);
     enable_delay_microseconds    = new IntSetting(EXTENDED, WG, NULL, "Stepper/Enable/Delay", DEFAULT_STEP_ENABLE_DELAY, 0, 1000);  // microseconds
 
     stallguard_debug_mask = new AxisMaskSetting(EXTENDED, WG, NULL, "Report/StallGuard", 0, postMotorSetting);
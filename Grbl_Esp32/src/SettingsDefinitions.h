@@ -2,6 +2,9 @@
 
 extern FlagSetting* verbose_errors;
 
+extern IntSetting* stream_ack_lines;
+extern IntSetting* stream_ack_ms;
+
 extern FakeSetting<int>* number_axis;
 
 extern AxisSettings* x_axis_settings;
@@ -37,6 +40,7 @@ extern FlagSetting*     hard_limits;
 extern FlagSetting*     homing_enable;
 extern FlagSetting*     laser_mode;
 extern IntSetting*      laser_full_power;
+extern IntSetting*      laser_power_updates;
 
 extern IntSetting*   status_mask;
 extern FloatSetting* junction_deviation;
@@ -62,6 +66,10 @@ extern FloatSetting* rpm_max;
 extern FloatSetting* rpm_min;
 extern FloatSetting* spindle_delay_spinup;
 extern FloatSetting* spindle_delay_spindown;
+extern FloatSetting* spindle_ramp_up;
+extern FloatSetting* spindle_ramp_down;
+extern FloatSetting* spindle_at_speed_tolerance;
+extern FloatSetting* spindle_at_speed_timeout;
 extern FloatSetting* coolant_start_delay;
 extern FlagSetting*  spindle_enbl_off_with_zero_speed;
 extern FlagSetting*  spindle_enable_invert;
@@ -79,6 +87,8 @@ extern FloatSetting* spindle_pwm_min_value;
 extern FloatSetting* spindle_pwm_max_value;
 extern IntSetting*   spindle_pwm_bit_precision;
 
+extern StringSetting* spindle_pwm_map;
+
 extern EnumSetting* spindle_type;
 
 extern FlagSetting*  atc_connected;
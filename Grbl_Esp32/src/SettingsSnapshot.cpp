@@ -0,0 +1,464 @@
+/*
+  SettingsSnapshot.cpp - All stored settings in one NVS blob
+  Part of Grbl_ESP32
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+
+  The image in RAM always holds the newest value of every key that has
+  been read or written since boot, so it can be exported at any time. It
+  is only written to NVS at boot, and only when the stored one was missing
+  or out of date, so changing a setting costs no more flash than before.
+
+  Settings load in the same order every boot, so lookups start where the
+  previous one matched and almost always hit the first record they try.
+*/
+
+#include "Grbl.h"
+
+static const char* SNAPSHOT_KEY = "Snapshot";
+
+const size_t SNAPSHOT_KEY_SIZE = 16;  // NVS keys are at most 15 characters
+
+typedef struct {
+    NvsType  type;
+    uint8_t  key_length;
+    uint16_t value_length;
+} snapshot_record_t;  // followed by the key, without a '\0', and the value
+
+static uint8_t*          image         = NULL;
+static size_t            image_length  = 0;
+static size_t            image_size    = 0;
+static size_t            cursor        = 0;
+static bool              stored        = false;  // NVS holds a snapshot of the image
+static bool              from_snapshot = false;
+static nvs_handle        nvsHandle     = 0;
+static SemaphoreHandle_t snapshotMutex = NULL;
+
+static uint8_t* import_buffer   = NULL;
+static size_t   import_length   = 0;
+static size_t   import_received = 0;
+
+static void lock() {
+    xSemaphoreTake(snapshotMutex, portMAX_DELAY);
+}
+
+static void unlock() {
+    xSemaphoreGive(snapshotMutex);
+}
+
+static snapshot_record_t record_at(size_t offset) {
+    snapshot_record_t record;
+    memcpy(&record, image + offset, sizeof(record));
+    return record;
+}
+
+static size_t record_size(const snapshot_record_t& record) {
+    return sizeof(record) + record.key_length + record.value_length;
+}
+
+static const uint8_t* value_at(size_t offset) {
+    return image + offset + sizeof(snapshot_record_t) + record_at(offset).key_length;
+}
+
+static bool key_matches(size_t offset, const char* key, size_t key_length) {
+    auto record = record_at(offset);
+    return record.key_length == key_length && !memcmp(image + offset + sizeof(record), key, key_length);
+}
+
+// Returns the offset of the record for key, or image_length if there is none
+static size_t find(const char* key) {
+    size_t key_length = strlen(key);
+    for (size_t offset = cursor; offset < image_length; offset += record_size(record_at(offset))) {
+        if (key_matches(offset, key, key_length)) {
+            cursor = offset + record_size(record_at(offset));
+            return offset;
+        }
+    }
+    for (size_t offset = 0; offset < cursor && offset < image_length; offset += record_size(record_at(offset))) {
+        if (key_matches(offset, key, key_length)) {
+            cursor = offset + record_size(record_at(offset));
+            return offset;
+        }
+    }
+    return image_length;
+}
+
+static bool put(const char* key, NvsType type, const void* value, size_t length) {
+    size_t key_length = strlen(key);
+    if (key_length >= SNAPSHOT_KEY_SIZE || length > UINT16_MAX) {
+        return false;
+    }
+    size_t offset = find(key);
+    if (offset < image_length) {
+        auto record = record_at(offset);
+        if (record.value_length == length) {
+            record.type = type;
+            memcpy(image + offset, &record, sizeof(record));
+            memcpy(image + offset + sizeof(record) + key_length, value, length);
+            return true;
+        }
+        // The size changed, so move the record to the end
+        size_t size = record_size(record);
+        memmove(image + offset, image + offset + size, image_length - offset - size);
+        image_length -= size;
+        cursor = 0;
+    }
+    snapshot_record_t record = { type, uint8_t(key_length), uint16_t(length) };
+    size_t            needed = image_length + record_size(record);
+    if (needed > image_size) {
+        size_t   size   = needed + 512;
+        uint8_t* larger = static_cast<uint8_t*>(realloc(image, size));
+        if (!larger) {
+            return false;
+        }
+        image      = larger;
+        image_size = size;
+    }
+    memcpy(image + image_length, &record, sizeof(record));
+    memcpy(image + image_length + sizeof(record), key, key_length);
+    memcpy(image + image_length + sizeof(record) + key_length, value, length);
+    image_length = needed;
+    return true;
+}
+
+// Copies key from its own NVS entry into the image
+static esp_err_t fetch(nvs_handle handle, const char* key, NvsType type) {
+    esp_err_t err;
+    switch (type) {
+        case NvsType::I8: {
+            int8_t value;
+            if ((err = nvs_get_i8(handle, key, &value)) == ESP_OK) {
+                put(key, type, &value, sizeof(value));
+            }
+            break;
+        }
+        case NvsType::I32: {
+            int32_t value;
+            if ((err = nvs_get_i32(handle, key, &value)) == ESP_OK) {
+                put(key, type, &value, sizeof(value));
+            }
+            break;
+        }
+        case NvsType::Str:
+        case NvsType::Blob: {
+            size_t length = 0;
+            err           = type == NvsType::Str ? nvs_get_str(handle, key, NULL, &length) : nvs_get_blob(handle, key, NULL, &length);
+            if (err == ESP_OK) {
+                uint8_t value[length];
+                err = type == NvsType::Str ? nvs_get_str(handle, key, (char*)value, &length) : nvs_get_blob(handle, key, value, &length);
+                if (err == ESP_OK) {
+                    put(key, type, value, length);
+                }
+            }
+            break;
+        }
+        default:
+            return ESP_ERR_NVS_TYPE_MISMATCH;
+    }
+    if (err == ESP_ERR_NVS_NOT_FOUND) {
+        put(key, NvsType::Absent, NULL, 0);
+    }
+    return err;
+}
+
+static esp_err_t direct_get(nvs_handle handle, const char* key, NvsType type, void* value, size_t* length) {
+    switch (type) {
+        case NvsType::I8:
+            return nvs_get_i8(handle, key, (int8_t*)value);
+        case NvsType::I32:
+            return nvs_get_i32(handle, key, (int32_t*)value);
+        case NvsType::Str:
+            return nvs_get_str(handle, key, (char*)value, length);
+        default:
+            return nvs_get_blob(handle, key, value, length);
+    }
+}
+
+static esp_err_t get(nvs_handle handle, const char* key, NvsType type, void* value, size_t* length) {
+    lock();
+    size_t offset = find(key);
+    if (offset == image_length || (record_at(offset).type != type && record_at(offset).type != NvsType::Absent)) {
+        esp_err_t err = fetch(handle, key, type);
+        if (err != ESP_OK) {
+            unlock();
+            return err;
+        }
+        offset = find(key);
+        if (offset == image_length) {  // Out of memory for the image
+            unlock();
+            return direct_get(handle, key, type, value, length);
+        }
+    }
+    auto      record = record_at(offset);
+    esp_err_t err    = ESP_OK;
+    if (record.type == NvsType::Absent) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    } else if (!length) {
+        memcpy(value, value_at(offset), record.value_length);
+    } else if (!value) {
+        *length = record.value_length;
+    } else if (*length < record.value_length) {
+        err = ESP_ERR_NVS_INVALID_LENGTH;
+    } else {
+        memcpy(value, value_at(offset), record.value_length);
+        *length = record.value_length;
+    }
+    unlock();
+    return err;
+}
+
+esp_err_t snapshot_get_i8(nvs_handle handle, const char* key, int8_t* value) {
+    return get(handle, key, NvsType::I8, value, NULL);
+}
+
+esp_err_t snapshot_get_i32(nvs_handle handle, const char* key, int32_t* value) {
+    return get(handle, key, NvsType::I32, value, NULL);
+}
+
+esp_err_t snapshot_get_str(nvs_handle handle, const char* key, char* value, size_t* length) {
+    return get(handle, key, NvsType::Str, value, length);
+}
+
+esp_err_t snapshot_get_blob(nvs_handle handle, const char* key, void* value, size_t* length) {
+    return get(handle, key, NvsType::Blob, value, length);
+}
+
+// Returns the header and records in one malloc()ed buffer. Must be called with the lock held.
+static uint8_t* serialize(size_t* length) {
+    snapshot_header_t header = { SNAPSHOT_MAGIC, SNAPSHOT_VERSION, crc16_ccitt(image, image_length), uint32_t(image_length) };
+    uint8_t*          buffer = static_cast<uint8_t*>(malloc(sizeof(header) + image_length));
+    if (buffer) {
+        memcpy(buffer, &header, sizeof(header));
+        memcpy(buffer + sizeof(header), image, image_length);
+        *length = sizeof(header) + image_length;
+    }
+    return buffer;
+}
+
+static bool save() {
+    size_t length;
+    lock();
+    uint8_t* buffer = serialize(&length);
+    unlock();
+    if (!buffer) {
+        return false;
+    }
+    // Too large for the cache, so this is written right away
+    stored = nvs_cache_set_blob(nvsHandle, SNAPSHOT_KEY, buffer, length) == ESP_OK;
+    free(buffer);
+    return stored;
+}
+
+static bool valid(const uint8_t* buffer, size_t length) {
+    snapshot_header_t header;
+    if (length < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, buffer, sizeof(header));
+    return header.magic == SNAPSHOT_MAGIC && header.version == SNAPSHOT_VERSION && header.length == length - sizeof(header) &&
+           header.crc == crc16_ccitt(buffer + sizeof(header), header.length);
+}
+
+void snapshot_begin(nvs_handle handle) {
+    nvsHandle     = handle;
+    snapshotMutex = xSemaphoreCreateMutex();
+
+    size_t length = 0;
+    if (nvs_get_blob(handle, SNAPSHOT_KEY, NULL, &length) != ESP_OK || length <= sizeof(snapshot_header_t)) {
+        return;
+    }
+    uint8_t* buffer = static_cast<uint8_t*>(malloc(length));
+    if (!buffer) {
+        return;
+    }
+    if (nvs_get_blob(handle, SNAPSHOT_KEY, buffer, &length) != ESP_OK || !valid(buffer, length)) {
+        grbl_msg_sendf(CLIENT_SERIAL, MsgLevel::Info, "Settings snapshot is damaged, loading each setting");
+        free(buffer);
+        return;
+    }
+    image_length = length - sizeof(snapshot_header_t);
+    memmove(buffer, buffer + sizeof(snapshot_header_t), image_length);
+    image         = buffer;
+    image_size    = length;
+    stored        = true;
+    from_snapshot = true;
+}
+
+void snapshot_end(int64_t start_us) {
+    int32_t elapsed_us = esp_timer_get_time() - start_us;
+    grbl_msg_sendf(CLIENT_SERIAL,
+                   MsgLevel::Info,
+                   "Settings loaded in %d us %s",
+                   elapsed_us,
+                   from_snapshot ? "from snapshot" : "one by one");
+    if (!stored && save()) {
+        grbl_msg_sendf(CLIENT_SERIAL, MsgLevel::Info, "Settings snapshot stored, %d bytes", int(image_length));
+    }
+}
+
+void snapshot_note(nvs_handle handle, const char* key, NvsType type, const void* value, size_t length) {
+    if (!snapshotMutex || !strcmp(key, SNAPSHOT_KEY)) {
+        return;
+    }
+    lock();
+    put(key, type, value, length);
+    bool was_stored = stored;
+    stored          = false;
+    unlock();
+    if (was_stored) {
+        // The write that follows may go straight to flash, and a cached erase could
+        // reach flash after it. A snapshot left behind by a power loss would then
+        // override the new value at the next boot, so it goes now.
+        nvs_cache_erase_key_now(handle, SNAPSHOT_KEY);
+    }
+}
+
+void snapshot_clear() {
+    lock();
+    image_length = 0;
+    cursor       = 0;
+    stored       = false;
+    unlock();
+}
+
+void snapshot_export(uint8_t client) {
+    size_t length;
+    lock();
+    uint8_t* buffer = serialize(&length);
+    unlock();
+    if (!buffer) {
+        grbl_msg_sendf(client, MsgLevel::Error, "Out of memory");
+        return;
+    }
+    for (size_t offset = 0; offset < length; offset += SNAPSHOT_CHUNK) {
+        char   hex[SNAPSHOT_CHUNK * 2 + 1];
+        size_t count = MIN(SNAPSHOT_CHUNK, length - offset);
+        for (size_t i = 0; i < count; i++) {
+            sprintf(hex + 2 * i, "%02X", buffer[offset + i]);
+        }
+        grbl_sendf(client, "[SNAPSHOT:%d,%s]\r\n", int(offset), hex);
+    }
+    free(buffer);
+}
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    c = toupper(c);
+    return (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+}
+
+// Writes every record of a complete import to NVS
+static Error apply(const uint8_t* records, size_t length) {
+    size_t offset = 0;
+    while (offset + sizeof(snapshot_record_t) <= length) {
+        snapshot_record_t record;
+        memcpy(&record, records + offset, sizeof(record));
+        if (record.key_length >= SNAPSHOT_KEY_SIZE || offset + record_size(record) > length) {
+            return Error::InvalidValue;
+        }
+        char key[SNAPSHOT_KEY_SIZE];
+        memcpy(key, records + offset + sizeof(record), record.key_length);
+        key[record.key_length] = '\0';
+        const uint8_t* value   = records + offset + sizeof(record) + record.key_length;
+        esp_err_t      err     = ESP_OK;
+        switch (record.type) {
+            case NvsType::Absent:
+                err = nvs_cache_erase_key(nvsHandle, key);
+                break;
+            case NvsType::I8:
+                err = record.value_length == 1 ? nvs_cache_set_i8(nvsHandle, key, int8_t(*value)) : ESP_ERR_NVS_INVALID_LENGTH;
+                break;
+            case NvsType::I32: {
+                int32_t i32;
+                memcpy(&i32, value, sizeof(i32));
+                err = record.value_length == sizeof(i32) ? nvs_cache_set_i32(nvsHandle, key, i32) : ESP_ERR_NVS_INVALID_LENGTH;
+                break;
+            }
+            case NvsType::Str:
+                err = (record.value_length && !value[record.value_length - 1]) ? nvs_cache_set_str(nvsHandle, key, (const char*)value)
+                                                                                 : ESP_ERR_NVS_INVALID_LENGTH;
+                break;
+            case NvsType::Blob:
+                err = nvs_cache_set_blob(nvsHandle, key, value, record.value_length);
+                break;
+            default:
+                return Error::InvalidValue;
+        }
+        if (err) {
+            return Error::NvsSetFailed;
+        }
+        offset += record_size(record);
+    }
+    return offset == length ? Error::Ok : Error::InvalidValue;
+}
+
+// Takes one "offset,hex" line of an export. The import is applied when the last one arrives.
+Error snapshot_import(const char* chunk) {
+    char*  hex;
+    size_t offset = strtoul(chunk, &hex, 10);
+    if (hex == chunk || *hex++ != ',' || strlen(hex) % 2) {
+        return Error::BadNumberFormat;
+    }
+    size_t  count = strlen(hex) / 2;
+    uint8_t bytes[count];
+    for (size_t i = 0; i < count; i++) {
+        int high = hex_digit(hex[2 * i]);
+        int low  = hex_digit(hex[2 * i + 1]);
+        if (high < 0 || low < 0) {
+            return Error::BadNumberFormat;
+        }
+        bytes[i] = high << 4 | low;
+    }
+
+    if (offset == 0) {
+        snapshot_header_t header;
+        free(import_buffer);
+        import_buffer   = NULL;
+        import_received = 0;
+        if (count < sizeof(header)) {
+            return Error::InvalidValue;
+        }
+        memcpy(&header, bytes, sizeof(header));
+        if (header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION || header.length > UINT16_MAX) {
+            return Error::InvalidValue;
+        }
+        import_length = sizeof(header) + header.length;
+        import_buffer = static_cast<uint8_t*>(malloc(import_length));
+        if (!import_buffer) {
+            return Error::InvalidValue;
+        }
+    }
+    if (!import_buffer || offset != import_received || offset + count > import_length) {
+        return Error::InvalidValue;  // Out of order; start again from offset 0
+    }
+    memcpy(import_buffer + offset, bytes, count);
+    import_received += count;
+    if (import_received < import_length) {
+        return Error::Ok;
+    }
+
+    Error err = valid(import_buffer, import_length) ? apply(import_buffer + sizeof(snapshot_header_t), import_length - sizeof(snapshot_header_t))
+                                                    : Error::InvalidValue;
+    free(import_buffer);
+    import_buffer = NULL;
+    if (err != Error::Ok) {
+        return err;
+    }
+    nvs_cache_flush();
+    save();
+    grbl_msg_sendf(CLIENT_ALL, MsgLevel::Info, "Settings imported, restart to use them");
+    return Error::Ok;
+}
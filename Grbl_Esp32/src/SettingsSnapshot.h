@@ -0,0 +1,79 @@
+#pragma once
+
+/*
+  SettingsSnapshot.h - All stored settings in one NVS blob
+  Part of Grbl_ESP32
+
+  Grbl is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  Grbl is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "Error.h"
+
+#include <nvs.h>
+#include <cstddef>
+#include <cstdint>
+
+// Loading a few hundred settings with one nvs_get_ call each is a large part
+// of the boot time. The snapshot keeps a copy of every key the settings have
+// read, so the next boot can get all of them with a single read.
+//
+// The settings read through snapshot_get_ calls, which take the place of the
+// nvs_get_ calls of the same name. A key that is not in the snapshot is read
+// from its own NVS entry, so a missing or damaged snapshot only costs time.
+// The first setting written after boot erases the stored snapshot from flash
+// before the new value is written, and the next boot stores a new one.
+//
+// The same image is what $Settings/Export prints and $Settings/Import takes.
+//
+//   header   magic, version, CRC-16/CCITT of the records, length of the records
+//   records  type (NvsType), key length, value length (16 bits), key, value
+const uint32_t SNAPSHOT_MAGIC   = 0x50414E53;  // "SNAP"
+const uint16_t SNAPSHOT_VERSION = 1;
+const int      SNAPSHOT_CHUNK   = 64;  // bytes per export line
+
+enum class NvsType : uint8_t {
+    Absent = 0,  // the key has no NVS entry, so the setting uses its default
+    I8,
+    I32,
+    Str,
+    Blob,
+};
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t crc;
+    uint32_t length;
+} snapshot_header_t;
+
+// Reads the stored snapshot, if it is valid. Called before any setting loads.
+void snapshot_begin(nvs_handle handle);
+
+// Called after the settings have loaded; stores a new snapshot if needed
+// and reports how long loading took.
+void snapshot_end(int64_t start_us);
+
+esp_err_t snapshot_get_i8(nvs_handle handle, const char* key, int8_t* value);
+esp_err_t snapshot_get_i32(nvs_handle handle, const char* key, int32_t* value);
+esp_err_t snapshot_get_str(nvs_handle handle, const char* key, char* value, size_t* length);
+esp_err_t snapshot_get_blob(nvs_handle handle, const char* key, void* value, size_t* length);
+
+// Called by the NVS cache for every value that is written or erased
+void snapshot_note(nvs_handle handle, const char* key, NvsType type, const void* value, size_t length);
+
+// Forgets every value, for when the whole namespace is erased
+void snapshot_clear();
+
+void  snapshot_export(uint8_t client);
+Error snapshot_import(const char* chunk);
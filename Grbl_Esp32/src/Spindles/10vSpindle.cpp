@@ -57,6 +57,7 @@ namespace Spindles {
         pinMode(_forward_pin, OUTPUT);
         pinMode(_reverse_pin, OUTPUT);
 
+        build_duty_lut();
         set_rpm(0);
 
         config_message();
@@ -80,8 +81,6 @@ namespace Spindles {
     }
 
     uint32_t _10v::set_rpm(uint32_t rpm) {
-        uint32_t pwm_value;
-
         if (_output_pin == UNDEFINED_PIN) {
             return rpm;
         }
@@ -97,14 +96,7 @@ namespace Spindles {
         }
         sys.spindle_speed = rpm;
 
-        // determine the pwm value
-        if (rpm == 0) {
-            pwm_value = _pwm_off_value;
-        } else {
-            pwm_value = map_uint32_t(rpm, _min_rpm, _max_rpm, _pwm_min_value, _pwm_max_value);
-        }
-
-        set_output(pwm_value);
+        set_output(rpm_to_duty(rpm));
         return rpm;
     }
 
@@ -78,8 +78,6 @@ namespace Spindles {
         _direction_pin = UNDEFINED_PIN;
         is_reversable  = false;
 
-        laser_mode->setBoolValue(true);
-
         _pwm_freq      = spindle_pwm_freq->get();
         _pwm_precision = calc_pwm_precision(_pwm_freq);  // detewrmine the best precision
         _pwm_period    = (1 << _pwm_precision);
@@ -119,6 +117,17 @@ namespace Spindles {
         digitalWrite(_direction_pin, Clockwise);
     }
 
+    // M4 and the laser off rapids follow $32, which is on while the laser is the spindle
+    void Laser::activate() {
+        PWM::activate();
+        laser_mode->setBoolValue(true);
+    }
+
+    void Laser::deactivate() {
+        PWM::deactivate();
+        laser_mode->setBoolValue(false);
+    }
+
     void Laser::deinit() {
         stop();
 
@@ -37,6 +37,8 @@ namespace Spindles {
         bool inLaserMode() override;
         void config_message() override;
         void get_pins_and_settings() override;
+        void activate() override;
+        void deactivate() override;
         void deinit() override;
 
         virtual ~Laser() {}
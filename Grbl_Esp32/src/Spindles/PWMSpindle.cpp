@@ -31,28 +31,76 @@
 //#include "grbl.h"
 
 namespace Spindles {
+    static portMUX_TYPE rampSpinlock = portMUX_INITIALIZER_UNLOCKED;
+
+    // A bucket of the duty table is 1 << LUT_SHIFT in the fixed point rpm_to_duty() uses
+    static const int LUT_SHIFT = 23;
+    static_assert((uint64_t(SPINDLE_PWM_LUT_SIZE) << LUT_SHIFT) <= (1ULL << 31), "SPINDLE_PWM_LUT_SIZE is too large");
+
     void PWM::init() {
+        if (!setup()) {
+            return;
+        }
+
+        activate();
+
+        config_message();
+    }
+
+    // Reads the settings and builds the duty table, but leaves the pins alone,
+    // so select() can get a spindle ready before M100-M102 switch to it
+    bool PWM::setup() {
         get_pins_and_settings();
 
         if (_output_pin == UNDEFINED_PIN) {
-            return;  // We cannot continue without the output pin
+            return false;  // We cannot continue without the output pin
         }
 
         if (_output_pin >= I2S_OUT_PIN_BASE) {
             grbl_msg_sendf(CLIENT_ALL, MsgLevel::Info, "Warning: Spindle output pin %s cannot do PWM", pinName(_output_pin).c_str());
-            return;
+            return false;
         }
 
         _current_state    = SpindleState::Disable;
         _current_pwm_duty = 0;
         use_delays        = false;
 
+        build_duty_lut();
+
+        if (_ramp_timer == nullptr) {
+            esp_timer_create_args_t args = {};
+            args.callback                = ramp_step;
+            args.arg                     = this;
+            args.name                    = "spindle_ramp";
+            esp_timer_create(&args, &_ramp_timer);
+        }
+        return true;
+    }
+
+    // Channel 0 is shared, so its frequency is set again for this spindle
+    void PWM::activate() {
+        if (_output_pin == UNDEFINED_PIN || _output_pin >= I2S_OUT_PIN_BASE) {
+            return;
+        }
+
         ledcSetup(_pwm_chan_num, (double)_pwm_freq, _pwm_precision);  // setup the channel
         ledcAttachPin(_output_pin, _pwm_chan_num);                    // attach the PWM to the pin
         pinMode(_enable_pin, OUTPUT);
         pinMode(_direction_pin, OUTPUT);
 
-        config_message();
+        _current_pwm_duty = -1;  // The last spindle left its own duty in the channel
+        stop();
+    }
+
+    void PWM::deactivate() {
+        if (_output_pin == UNDEFINED_PIN || _output_pin >= I2S_OUT_PIN_BASE) {
+            return;
+        }
+
+        stop();
+        ledcDetachPin(_output_pin);
+        pinMode(_output_pin, OUTPUT);
+        digitalWrite(_output_pin, _invert_pwm);
     }
 
     // Get the GPIO from the machine definition
@@ -101,25 +149,19 @@ namespace Spindles {
         _pwm_min_value = (_pwm_period * spindle_pwm_min_value->get() / 100.0);
         _pwm_max_value = (_pwm_period * spindle_pwm_max_value->get() / 100.0);
 
-#ifdef ENABLE_PIECEWISE_LINEAR_SPINDLE
-        _min_rpm          = RPM_MIN;
-        _max_rpm          = RPM_MAX;
-        _piecewide_linear = true;
-#else
         _min_rpm          = rpm_min->get();
         _max_rpm          = rpm_max->get();
-        _piecewide_linear = false;
-#endif
+        _piecewide_linear = spindle_pwm_map->get()[0] != '\0';
 
         _pwm_chan_num = 0;  // Channel 0 is reserved for spindle use
 
         _spinup_delay   = spindle_delay_spinup->get() * 1000.0;
         _spindown_delay = spindle_delay_spindown->get() * 1000.0;
+        _ramp_up_ms     = spindle_ramp_up->get() * 1000.0;
+        _ramp_down_ms   = spindle_ramp_down->get() * 1000.0;
     }
 
     uint32_t PWM::set_rpm(uint32_t rpm) {
-        uint32_t pwm_value;
-
         if (_output_pin == UNDEFINED_PIN) {
             return rpm;
         }
@@ -134,25 +176,238 @@ namespace Spindles {
             rpm = _min_rpm;
         }
 
-        sys.spindle_speed = rpm;
+        // A ramp is never used in laser mode. The stepper ISR sets the speed of every
+        // segment, which must not cut short a ramp that M3, M4 or M5 started.
+        bool ramped = (_ramp_up_ms || _ramp_down_ms) && !laser_mode->get();
+        if (ramped && xPortInIsrContext()) {
+            if (ramp_retarget(rpm)) {
+                return rpm;
+            }
+            ramp_set(rpm);
+        } else if (ramped) {
+            ramp_to(rpm);
+        } else {
+            ramp_set(rpm);
+        }
+
+        set_enable_pin(gc_state.modal.spindle != SpindleState::Disable);
+
+        return rpm;
+    }
 
-        if (_piecewide_linear) {
-            //pwm_value = piecewise_linear_fit(rpm); TODO
-            pwm_value = 0;
-            grbl_msg_sendf(CLIENT_ALL, MsgLevel::Info, "Warning: Linear fit not implemented yet.");
+    uint32_t PWM::rpm_to_duty(uint32_t rpm) {
+        if (rpm == 0) {
+            return _pwm_off_value;
+        }
+        if (_duty_lut == nullptr) {
+            return curve_duty(rpm, nullptr, 0);
+        }
+        if (rpm >= _max_rpm) {
+            return _duty_lut[SPINDLE_PWM_LUT_SIZE];
+        }
+        uint32_t pos    = rpm > _min_rpm ? (rpm - _min_rpm) * _lut_scale : 0;
+        uint32_t bucket = pos >> LUT_SHIFT;
+        if (bucket >= SPINDLE_PWM_LUT_SIZE) {
+            return _duty_lut[SPINDLE_PWM_LUT_SIZE];
+        }
+        int32_t step = int32_t(_duty_lut[bucket + 1] - _duty_lut[bucket]);
+        int32_t frac = (pos >> (LUT_SHIFT - 8)) & 0xff;
+        return _duty_lut[bucket] + step * frac / 256;
+    }
+
+    // Called when the spindle starts, since the table depends on $30, $31, $34-$36 and
+    // $Spindle/PWM/Map, and a change to any of them restarts the spindle.
+    void PWM::build_duty_lut() {
+        MapPoint points[SPINDLE_PWM_MAP_POINTS];
+        int      n_points = _piecewide_linear ? parse_map(spindle_pwm_map->get(), points) : 0;
+        if (n_points < 0) {
+            grbl_msg_sendf(CLIENT_ALL, MsgLevel::Info, "Warning: Invalid $Spindle/PWM/Map ignored");
+            n_points = 0;
+        }
+
+        if (_duty_lut == nullptr) {
+            _duty_lut = new uint32_t[SPINDLE_PWM_LUT_SIZE + 1];
+        }
+
+        uint32_t range = _max_rpm > _min_rpm ? _max_rpm - _min_rpm : 0;
+        _lut_scale     = range ? (uint64_t(SPINDLE_PWM_LUT_SIZE) << LUT_SHIFT) / range : 0;
+        for (int i = 0; i <= SPINDLE_PWM_LUT_SIZE; i++) {
+            uint32_t rpm = range ? _min_rpm + uint64_t(range) * i / SPINDLE_PWM_LUT_SIZE : _max_rpm;
+            _duty_lut[i] = curve_duty(rpm, points, n_points);
+        }
+    }
 
+    // The duty for rpm, from the map points if there are any, else from $34-$36
+    uint32_t PWM::curve_duty(uint32_t rpm, const MapPoint* points, int n_points) {
+        if (n_points == 0) {
+            if (_max_rpm <= _min_rpm) {
+                return _pwm_max_value;  // No PWM range possible
+            }
+            return map_uint32_t(rpm, _min_rpm, _max_rpm, _pwm_min_value, _pwm_max_value);
+        }
+
+        float percent = points[n_points - 1].percent;
+        if (rpm <= points[0].rpm) {
+            percent = points[0].percent;
         } else {
-            if (rpm == 0) {
-                pwm_value = _pwm_off_value;
-            } else {
-                pwm_value = map_uint32_t(rpm, _min_rpm, _max_rpm, _pwm_min_value, _pwm_max_value);
+            for (int i = 1; i < n_points; i++) {
+                if (rpm <= points[i].rpm) {
+                    const MapPoint& a = points[i - 1];
+                    const MapPoint& b = points[i];
+                    percent           = a.percent + (b.percent - a.percent) * (rpm - a.rpm) / (b.rpm - a.rpm);
+                    break;
+                }
             }
         }
+        return _pwm_period * percent / 100.0;
+    }
 
-        set_enable_pin(gc_state.modal.spindle != SpindleState::Disable);
-        set_output(pwm_value);
+    int PWM::parse_map(const char* text, MapPoint* points) {
+        int n_points = 0;
+        while (*text) {
+            if (n_points == SPINDLE_PWM_MAP_POINTS) {
+                return -1;
+            }
+            char* end;
+            float rpm = strtof(text, &end);
+            if (end == text || *end != ':' || rpm < 0) {
+                return -1;
+            }
+            text          = end + 1;
+            float percent = strtof(text, &end);
+            if (end == text || percent < 0 || percent > 100) {
+                return -1;
+            }
+            if (n_points && uint32_t(rpm) <= points[n_points - 1].rpm) {
+                return -1;  // The speeds must go up
+            }
+            points[n_points].rpm     = rpm;
+            points[n_points].percent = percent;
+            n_points++;
+
+            if (*end == ',') {
+                end++;
+            } else if (*end) {
+                return -1;
+            }
+            text = end;
+        }
+        return n_points == 1 ? -1 : n_points;  // One point is not a curve
+    }
+
+    // Takes the first step right away, so the spindle is on when this returns
+    void PWM::ramp_to(uint32_t rpm) {
+        portENTER_CRITICAL(&rampSpinlock);
+        _ramp_target = rpm;
+        bool done    = ramp_advance();
+        bool arm     = !done && !_ramp_armed;  // else a step in flight carries on to the new target
+        _ramping     = !done;
+        if (arm) {
+            _ramp_armed = true;
+        }
+        portEXIT_CRITICAL(&rampSpinlock);
+
+        if (arm) {
+            esp_timer_start_once(_ramp_timer, SPINDLE_RAMP_TICK * 1000);
+        }
+        if (done) {
+            ramp_done(rpm);
+        }
+    }
+
+    // Laser mode calls this from the stepper ISR
+    void PWM::ramp_set(uint32_t rpm) {
+        bool isr = xPortInIsrContext();
+        if (isr) {
+            portENTER_CRITICAL_ISR(&rampSpinlock);
+        } else {
+            portENTER_CRITICAL(&rampSpinlock);
+        }
+        _ramping          = false;  // A step that is already due does nothing
+        _ramp_rpm         = rpm;
+        _ramp_target      = rpm;
+        sys.spindle_speed = rpm;
+        set_output(rpm_to_duty(rpm));
+        if (isr) {
+            portEXIT_CRITICAL_ISR(&rampSpinlock);
+        } else {
+            portEXIT_CRITICAL(&rampSpinlock);
+        }
+    }
+
+    // From the stepper ISR, which can't arm the ramp timer: moves the target of a ramp
+    // that runs. Returns false if there is none and rpm is a new speed.
+    bool PWM::ramp_retarget(uint32_t rpm) {
+        portENTER_CRITICAL_ISR(&rampSpinlock);
+        bool handled = _ramping || rpm == _ramp_target;
+        if (_ramping) {
+            _ramp_target = rpm;
+        }
+        portEXIT_CRITICAL_ISR(&rampSpinlock);
+        return handled;
+    }
+
+    // For when the next step must not overlap the ramp
+    void PWM::wait_for_ramp() {
+        while (_ramping && !sys.abort) {
+            protocol_exec_rt_system();
+            delay(SPINDLE_RAMP_TICK);
+        }
+    }
+
+    // Moves the output one step toward _ramp_target. Must be called with rampSpinlock held.
+    // Returns true once the target is reached.
+    bool PWM::ramp_advance() {
+        uint32_t rpm    = _ramp_rpm;
+        uint32_t target = _ramp_target;
+        uint32_t range  = _max_rpm > _min_rpm ? _max_rpm - _min_rpm : _max_rpm;
+        if (rpm < target) {
+            uint32_t step = _ramp_up_ms ? range * SPINDLE_RAMP_TICK / _ramp_up_ms + 1 : target;
+            rpm           = (rpm < _min_rpm ? _min_rpm : rpm) + step;  // Below min rpm the output is at min already
+            if (rpm > target) {
+                rpm = target;
+            }
+        } else if (rpm > target) {
+            uint32_t step = _ramp_down_ms ? range * SPINDLE_RAMP_TICK / _ramp_down_ms + 1 : rpm;
+            rpm           = rpm - target > step ? rpm - step : target;
+            if (rpm < _min_rpm) {
+                rpm = target;
+            }
+        }
+        _ramp_rpm         = rpm;
+        sys.spindle_speed = rpm;
+        set_output(rpm_to_duty(rpm));
+        return rpm == target;
+    }
+
+    void PWM::ramp_done(uint32_t rpm) {
+        if (rpm == 0) {
+            set_enable_pin(_current_state != SpindleState::Disable);  // for $Spindle/Enable/OffWithSpeed
+        }
+    }
+
+    void PWM::ramp_step(void* arg) {
+        auto pwm = static_cast<PWM*>(arg);
+
+        portENTER_CRITICAL(&rampSpinlock);
+        if (!pwm->_ramping) {
+            pwm->_ramp_armed = false;  // Stopped or set since this step was armed
+            portEXIT_CRITICAL(&rampSpinlock);
+            return;
+        }
+        uint32_t target = pwm->_ramp_target;
+        bool     done   = pwm->ramp_advance();
+        if (done) {
+            pwm->_ramping    = false;
+            pwm->_ramp_armed = false;
+        }
+        portEXIT_CRITICAL(&rampSpinlock);
 
-        return 0;
+        if (done) {
+            pwm->ramp_done(target);
+        } else {
+            esp_timer_start_once(pwm->_ramp_timer, SPINDLE_RAMP_TICK * 1000);
+        }
     }
 
     void PWM::set_state(SpindleState state, uint32_t rpm) {
@@ -164,14 +419,15 @@ namespace Spindles {
             sys.spindle_speed = 0;
             stop();
             if (use_delays && (_current_state != state)) {
-                delay(_spindown_delay);
+                wait_for_speed(0, _spindown_delay);
             }
         } else {
             set_dir_pin(state == SpindleState::Cw);
-            set_rpm(rpm);
+            rpm = set_rpm(rpm);
             set_enable_pin(state != SpindleState::Disable);  // must be done after setting rpm for enable features to work
-            if (use_delays && (_current_state != state)) {
-                delay(_spinup_delay);
+            if (use_delays) {
+                // A speed change only waits if the spindle can tell when it is done
+                wait_for_speed(rpm, _current_state != state ? _spinup_delay : 0);
             }
         }
 
@@ -192,7 +448,7 @@ namespace Spindles {
 
     void PWM::stop() {
         // inverts are delt with in methods
-        set_output(_pwm_off_value);
+        ramp_set(0);  // The off duty is written under the same lock a ramp step takes
         set_enable_pin(false);
     }
 
@@ -23,6 +23,8 @@
 */
 #include "Spindle.h"
 
+#include <esp_timer.h>
+
 namespace Spindles {
     // This adds support for PWM
     class PWM : public Spindle {
@@ -34,12 +36,28 @@ namespace Spindles {
         PWM& operator=(const PWM&) = delete;
         PWM& operator=(PWM&&)      = delete;
 
+        // A point of $Spindle/PWM/Map
+        struct MapPoint {
+            uint32_t rpm;
+            float    percent;
+        };
+
+        // Reads "rpm:percent,rpm:percent,..." into points, which must hold SPINDLE_PWM_MAP_POINTS.
+        // Returns the number of points, or -1 if the text is not a valid map.
+        static int parse_map(const char* text, MapPoint* points);
+
         void             init() override;
         virtual uint32_t set_rpm(uint32_t rpm) override;
         void             set_state(SpindleState state, uint32_t rpm) override;
         SpindleState     get_state() override;
         void             stop() override;
         void             config_message() override;
+        uint32_t         min_rpm() override { return _min_rpm; }
+        uint32_t         max_rpm() override { return _max_rpm; }
+
+        void activate() override;
+        void deactivate() override;
+        bool setup();
 
         virtual void deinit();
         virtual void get_pins_and_settings();
@@ -60,14 +78,45 @@ namespace Spindles {
         uint32_t _pwm_freq;
         uint32_t _pwm_period;  // how many counts in 1 period
         uint8_t  _pwm_precision;
-        bool     _piecewide_linear;
+        bool     _piecewide_linear;  // use $Spindle/PWM/Map instead of $34-$36
         bool     _off_with_zero_speed;
         bool     _invert_pwm;
+        uint32_t _ramp_up_ms   = 0;  // from min to max rpm; 0 sets a new speed right away
+        uint32_t _ramp_down_ms = 0;
 
         virtual void set_dir_pin(bool Clockwise);
         virtual void set_output(uint32_t duty);
         virtual void set_enable_pin(bool enable_pin);
 
-        uint8_t calc_pwm_precision(uint32_t freq);
+        uint8_t  calc_pwm_precision(uint32_t freq);
+        uint32_t rpm_to_duty(uint32_t rpm);
+        void     build_duty_lut();
+        void     ramp_to(uint32_t rpm);
+        void     ramp_set(uint32_t rpm);  // ends any ramp and sets rpm right away
+        bool     ramp_retarget(uint32_t rpm);
+        void     wait_for_ramp();
+
+    private:
+        // The ramp runs from a one shot esp_timer that each step arms again, so it never
+        // blocks the caller. sys.spindle_speed follows the speed the output is set to.
+        // These, and the output while a ramp may run, only change under rampSpinlock,
+        // and a step that finds _ramping cleared does nothing.
+        esp_timer_handle_t _ramp_timer  = nullptr;
+        volatile bool      _ramping     = false;
+        volatile bool      _ramp_armed  = false;  // a step is due or running
+        volatile uint32_t  _ramp_rpm    = 0;
+        volatile uint32_t  _ramp_target = 0;
+
+        bool        ramp_advance();
+        void        ramp_done(uint32_t rpm);
+        static void ramp_step(void* arg);
+
+        // rpm_to_duty() is called per segment from the stepper ISR, so the speed curve
+        // is expanded by build_duty_lut() into SPINDLE_PWM_LUT_SIZE buckets from min to
+        // max rpm, and read with a linear step between the two ends of a bucket.
+        uint32_t* _duty_lut  = nullptr;
+        uint32_t  _lut_scale = 0;  // buckets per rpm, with LUT_SHIFT fractional bits
+
+        uint32_t curve_duty(uint32_t rpm, const MapPoint* points, int n_points);
     };
 }
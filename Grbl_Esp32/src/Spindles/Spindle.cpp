@@ -41,6 +41,7 @@
 #include "YL620Spindle.h"
 #include "TecoL510.h"
 #include "AsdaCN1.h"
+#include "Tachometer.h"
 
 namespace Spindles {
     // An instance of each type of spindle is created here.
@@ -59,6 +60,19 @@ namespace Spindles {
     L510     l510;
     AsdaCN1  Asda_CN1;
 
+    // The spindles M100-M102 switch between. They share LEDC channel 0 and
+    // some of the pins, so only one of them is active at a time.
+    static PWM* const modes[] = { &pwm, &laser, &Asda_CN1 };
+
+    static bool is_mode(Spindle* s) {
+        for (PWM* mode : modes) {
+            if (mode == s) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     void Spindle::select() {
         gc_state.spindle_speed = 0;  // Set S value to 0
         null.deinit();
@@ -77,47 +91,77 @@ namespace Spindles {
         Asda_CN1.get_pins_and_settings();
         Asda_CN1.deinit();
 
-        switch (static_cast<SpindleType>(spindle_type->get())) {
+        tach_init();
+
+        spindle = find(static_cast<SpindleType>(spindle_type->get()));
+        if (is_mode(spindle)) {
+            // M100-M102 switch to the others without a select(), so they get ready too
+            for (PWM* mode : modes) {
+                if (mode != spindle) {
+                    mode->setup();
+                }
+            }
+        }
+
+        spindle->init();
+    }
+
+    Spindle* Spindle::find(SpindleType type) {
+        switch (type) {
             case SpindleType::PWM:
-                spindle = &pwm;
-                break;
+                return &pwm;
             case SpindleType::RELAY:
-                spindle = &relay;
-                break;
+                return &relay;
             case SpindleType::LASER:
-                spindle = &laser;
-                break;
+                return &laser;
             case SpindleType::DAC:
-                spindle = &dac;
-                break;
+                return &dac;
             case SpindleType::HUANYANG:
-                spindle = &huanyang;
-                break;
+                return &huanyang;
             case SpindleType::BESC:
-                spindle = &besc;
-                break;
+                return &besc;
             case SpindleType::_10V:
-                spindle = &_10v;
-                break;
+                return &_10v;
             case SpindleType::H2A:
-                spindle = &h2a;
-                break;
+                return &h2a;
             case SpindleType::YL620:
-                spindle = &yl620;
-                break;
+                return &yl620;
             case SpindleType::L510:
-                spindle = &l510;
-                break;
+                return &l510;
             case SpindleType::ASDA_CN1:
-                spindle = &Asda_CN1;
-                break;
+                return &Asda_CN1;
             case SpindleType::NONE:
             default:
-                spindle = &null;
-                break;
+                return &null;
         }
+    }
 
-        spindle->init();
+    Error Spindle::switch_to(SpindleType type) {
+        Spindle* next = find(type);
+        if (!is_mode(spindle) || !is_mode(next)) {
+            return spindle_type->setEnumValue(static_cast<int8_t>(type));  // the full change, as from $Spindle/Type
+        }
+        if (atc_connected->get() && type != SpindleType::ASDA_CN1 && !gc_state.Rownd_special) {
+            return Error::AtcIncompatibleOperation;
+        }
+        if (sys.state == State::CheckMode) {
+            return Error::Ok;
+        }
+
+        // The step ISR sets the speed of the spindle on each segment, so the pointer only changes when it is done
+        protocol_buffer_synchronize();
+        if (gc_state.modal.spindle != SpindleState::Disable) {
+            gc_state.modal.spindle = SpindleState::Disable;
+            spindle->set_state(SpindleState::Disable, 0);
+        }
+        gc_state.spindle_speed = 0;  // Set S value to 0
+
+        if (next != spindle) {
+            spindle->deactivate();
+            spindle = next;
+            spindle->activate();
+        }
+        return spindle_type->setEnumValue(static_cast<int8_t>(type));  // checkSpindleType() sees that it is already active
     }
 
     // ========================= Spindle ==================================
@@ -126,6 +170,14 @@ namespace Spindles {
         return false;  // default for basic spindle is false
     }
 
+    uint32_t Spindle::min_rpm() {
+        return rpm_min->get();
+    }
+
+    uint32_t Spindle::max_rpm() {
+        return rpm_max->get();
+    }
+
     void Spindle::sync(SpindleState state, uint32_t rpm) {
         if (sys.state == State::CheckMode) {
             return;
@@ -137,6 +189,65 @@ namespace Spindles {
     void Spindle::deinit() {
         stop();
     }
+
+    void Spindle::activate() {
+        init();
+    }
+
+    void Spindle::deactivate() {
+        deinit();
+    }
+
+    bool Spindle::get_actual_rpm(uint32_t& rpm) {
+        if (SPINDLE_TACH_PIN == UNDEFINED_PIN) {
+            return false;
+        }
+        rpm = tach_rpm();
+        return true;
+    }
+
+    bool Spindle::wait_for_speed(uint32_t rpm, uint32_t delay_ms) {
+        uint32_t actual;
+        if (!get_actual_rpm(actual)) {
+            delay(delay_ms);
+            return true;
+        }
+
+        uint32_t band = rpm * spindle_at_speed_tolerance->get() / 100.0;
+        if (band < 100) {
+            band = 100;  // Just a sanity check
+        }
+        uint32_t low  = rpm > band ? rpm - band : 0;
+        uint32_t high = rpm + band;
+
+        // The timeout starts over whenever the spindle gets closer to the requested
+        // speed, so a slow spindle is fine as long as it keeps going.
+        int64_t  timeout_us = spindle_at_speed_timeout->get() * 1000000.0;
+        int64_t  deadline   = esp_timer_get_time() + timeout_us;
+        uint32_t closest    = UINT32_MAX;
+
+        while (actual < low || actual > high) {
+            uint32_t distance = actual > rpm ? actual - rpm : rpm - actual;
+            if (distance < closest) {
+                closest  = distance;
+                deadline = esp_timer_get_time() + timeout_us;
+            } else if (esp_timer_get_time() > deadline) {
+                grbl_msg_sendf(CLIENT_ALL, MsgLevel::Error, "Spindle did not reach %d rpm. Measured speed is %d rpm.", rpm, actual);
+                mc_reset();
+                sys_rt_exec_alarm = ExecAlarm::SpindleControl;
+                return false;
+            }
+
+            // Only the system commands; this also runs while restoring from a parking motion.
+            protocol_exec_rt_system();
+            if (sys.abort) {
+                return false;
+            }
+            delay(SPINDLE_AT_SPEED_POLL);
+            get_actual_rpm(actual);
+        }
+        return true;
+    }
 }
 
 Spindles::Spindle* spindle;
@@ -71,6 +71,24 @@ namespace Spindles {
         virtual void         sync(SpindleState state, uint32_t rpm);
         virtual void         deinit();
 
+        // Hands the output pins over between spindles that select() has already
+        // set up. The defaults do the full init() and deinit().
+        virtual void activate();
+        virtual void deactivate();
+
+        // The speed range the spindle holds a commanded speed to. The defaults are $31 and $30.
+        virtual uint32_t min_rpm();
+        virtual uint32_t max_rpm();
+
+        // The measured speed, for spindles that can measure it. The default
+        // reads the tachometer on SPINDLE_TACH_PIN, if there is one.
+        virtual bool get_actual_rpm(uint32_t& rpm);
+
+        // Waits until the spindle runs within $Spindle/AtSpeed/Tolerance of rpm.
+        // A spindle that cannot measure its speed waits delay_ms instead.
+        // Returns false after an abort, or a timeout, which raises an alarm.
+        bool wait_for_speed(uint32_t rpm, uint32_t delay_ms);
+
         virtual ~Spindle() {}
 
         bool                  is_reversable;
@@ -79,7 +97,12 @@ namespace Spindles {
         uint32_t              _spinup_delay;
         uint32_t              _spindown_delay;
 
-        static void select();
+        static void     select();
+        static Spindle* find(SpindleType type);
+
+        // M100-M102 switch between the PWM, laser and lathe chuck spindles
+        // without a select(), and store the new $Spindle/Type.
+        static Error switch_to(SpindleType type);
     };
 
 }
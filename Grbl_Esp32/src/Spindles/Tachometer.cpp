@@ -0,0 +1,59 @@
+/*
+    Tachometer.cpp
+
+    Part of Grbl_ESP32
+
+    Grbl is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    Grbl is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+#include "Spindle.h"
+#include "Tachometer.h"
+
+static int64_t      last_pulse_us = 0;
+static uint32_t     period_us     = 0;
+static portMUX_TYPE tachSpinlock  = portMUX_INITIALIZER_UNLOCKED;
+
+static void IRAM_ATTR isr_tach() {
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL_ISR(&tachSpinlock);
+    if (last_pulse_us != 0) {
+        period_us = uint32_t(now - last_pulse_us);
+    }
+    last_pulse_us = now;
+    portEXIT_CRITICAL_ISR(&tachSpinlock);
+}
+
+void tach_init() {
+    static bool attached = false;
+    if (SPINDLE_TACH_PIN == UNDEFINED_PIN || attached) {
+        return;
+    }
+    pinMode(SPINDLE_TACH_PIN, INPUT_PULLUP);
+    attachInterrupt(digitalPinToInterrupt(SPINDLE_TACH_PIN), isr_tach, RISING);
+    attached = true;
+    grbl_msg_sendf(CLIENT_SERIAL, MsgLevel::Info, "Spindle tachometer on %s, %d pulses/rev", pinName(SPINDLE_TACH_PIN).c_str(), SPINDLE_TACH_PPR);
+}
+
+uint32_t tach_rpm() {
+    portENTER_CRITICAL(&tachSpinlock);
+    int64_t  last   = last_pulse_us;
+    uint32_t period = period_us;
+    portEXIT_CRITICAL(&tachSpinlock);
+
+    if (last == 0 || period == 0) {
+        return 0;
+    }
+    int64_t since = esp_timer_get_time() - last;
+    if (since > period) {
+        period = since > UINT32_MAX ? UINT32_MAX : uint32_t(since);
+    }
+    return uint32_t(60000000ULL / (uint64_t(period) * SPINDLE_TACH_PPR));
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+/*
+    Tachometer.h
+
+    Measures the spindle speed from pulses on SPINDLE_TACH_PIN, for spindles
+    that cannot report their own speed. Define SPINDLE_TACH_PIN and, if the
+    sensor gives more than one pulse per revolution, SPINDLE_TACH_PPR in the
+    machine definition.
+
+    Part of Grbl_ESP32
+
+    Grbl is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    Grbl is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with Grbl.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <cstdint>
+
+void tach_init();
+
+// The speed from the time between the last two pulses. When pulses stop
+// coming, the time since the last one is used, so the speed falls to zero.
+uint32_t tach_rpm();
@@ -38,15 +38,17 @@
 
 // Timing and modbus... The manual states that between communications, we should respect a
 // silent interval of 3,5 characters. If we received communications between these times, we
-// have to assume that the message is broken. We use a poll rate of 250 ms here, which should
-// be plenty: assuming 9600 8N1, that's roughly 250 chars. A message of 2x16 chars with 4x4
-// chars buffering is just 40 chars.
+// have to assume that the message is broken. Commands are sent as soon as that interval has
+// passed, so a new speed reaches the VFD within one transaction. Polls are spread out: every
+// 250 ms while the spindle runs, once a second while it is off, and back to back while
+// waiting for the spindle to reach speed.
 
 const int        VFD_RS485_UART_PORT  = 2;  // hard coded for this port right now
 const int        VFD_RS485_BUF_SIZE   = 127;
 const int        VFD_RS485_QUEUE_SIZE = 10;                                         // numv\ber of commands that can be queued up.
 const int        RESPONSE_WAIT_MILLIS = 1000;                                       // how long to wait for a response in milliseconds
-const int        VFD_RS485_POLL_RATE  = 250;                                        // in milliseconds between commands
+const int        VFD_RS485_POLL_RATE  = 250;                                        // in milliseconds between polls while running
+const int        VFD_RS485_IDLE_POLL  = 1000;                                       // in milliseconds between polls while off
 const TickType_t response_ticks       = RESPONSE_WAIT_MILLIS / portTICK_PERIOD_MS;  // in milliseconds between commands
 
 // OK to change these
@@ -60,6 +62,13 @@ namespace Spindles {
     QueueHandle_t VFD::vfd_cmd_queue     = nullptr;
     TaskHandle_t  VFD::vfd_cmdTaskHandle = nullptr;
 
+    VFD::ModbusCommand VFD::speed_cmd;
+    bool               VFD::speed_pending  = false;
+    portMUX_TYPE       VFD::speed_spinlock = portMUX_INITIALIZER_UNLOCKED;
+    VFD::TrafficStats  VFD::stats[int(Traffic::Count)];
+
+    static const char* traffic_names[] = { "Mode", "Speed", "Init", "Poll" };
+
     VFD::VFD() :
         _txd_pin(
 #ifdef VFD_RS485_TXD_PIN
@@ -107,23 +116,52 @@ namespace Spindles {
         ModbusCommand next_cmd;
         uint8_t       rx_message[VFD_RS485_MAX_MSG_SIZE];
         bool          safetyPollingEnabled = instance->safety_polling();
+        int64_t       next_poll_us         = 0;
+
+        // 3.5 characters of 11 bits; the spec fixes the interval at 1750 us above 19200 baud.
+        int        silent_us    = instance->_baudrate > 19200 ? 1750 : 38500000 / instance->_baudrate;
+        TickType_t silent_ticks = (silent_us + 999) / 1000 / portTICK_PERIOD_MS + 1;
 
         while (true) {
-            response_parser parser = nullptr;
+            response_parser parser  = nullptr;
+            Traffic         traffic = Traffic::Poll;
 
             next_cmd.msg[0] = VFD_RS485_ADDR;  // Always default to this
 
-            // First check if we should ask the VFD for the max RPM value as part of the initialization. We
-            // should also query this is max_rpm is 0, because that means a previous initialization failed:
-            if ((pollidx < 0 || instance->_max_rpm == 0) && (parser = instance->initialization_sequence(pollidx, next_cmd)) != nullptr) {
-                next_cmd.critical = false;
+            // Commands go first, in order: mode changes, then the newest speed. Everything
+            // else waits until the next poll is due.
+            if (xQueueReceive(vfd_cmd_queue, &next_cmd, 0) == pdTRUE) {
+                traffic = Traffic::Mode;
+            } else if (take_speed_command(next_cmd)) {
+                traffic = Traffic::Speed;
             } else {
-                pollidx           = 1;  // Done with initialization. Main sequence.
-                next_cmd.critical = false;
+                int64_t now = esp_timer_get_time();
+                if (now < next_poll_us) {
+                    ulTaskNotifyTake(pdTRUE, (next_poll_us - now) / 1000 / portTICK_PERIOD_MS + 1);
+                    continue;
+                }
+                if (instance->_syncing) {
+                    next_poll_us = now;  // Waiting for the spindle to reach speed, so poll as fast as we can
+                } else if (instance->_current_state == SpindleState::Disable && pollidx > 0) {
+                    next_poll_us = now + VFD_RS485_IDLE_POLL * 1000LL;  // Initialized and off
+                } else {
+                    next_poll_us = now + VFD_RS485_POLL_RATE * 1000LL;
+                }
+                next_cmd.critical  = false;
+                next_cmd.queued_us = now;
             }
 
-            // If we don't have a parser, the queue goes first. During idle, we can grab a parser.
-            if (parser == nullptr && xQueueReceive(vfd_cmd_queue, &next_cmd, 0) != pdTRUE) {
+            // Ask the VFD for the max RPM value as part of the initialization. We should also
+            // query this is max_rpm is 0, because that means a previous initialization failed:
+            if (traffic != Traffic::Poll) {
+                // Commands don't have a parser
+            } else if ((pollidx < 0 || instance->_max_rpm == 0) && (parser = instance->initialization_sequence(pollidx, next_cmd)) != nullptr) {
+                traffic = Traffic::Init;
+            } else {
+                if (pollidx < 0) {
+                    pollidx = 1;  // Done with initialization. Main sequence.
+                }
+
                 // We poll in a cycle. Note that the switch will fall through unless we encounter a hit.
                 // The weakest form here is 'get_status_ok' which should be implemented if the rest fails.
                 if (instance->_syncing) {
@@ -158,7 +196,9 @@ namespace Spindles {
                 // If we have no parser, that means get_status_ok is not implemented (and we have
                 // nothing resting in our queue). Let's fall back on a simple continue.
                 if (parser == nullptr) {
-                    vTaskDelay(VFD_RS485_POLL_RATE / portTICK_PERIOD_MS);
+                    if (next_poll_us <= esp_timer_get_time()) {
+                        next_poll_us += VFD_RS485_POLL_RATE * 1000LL;
+                    }
                     continue;  // main while loop
                 }
             }
@@ -183,6 +223,7 @@ namespace Spindles {
 
             // Assume for the worst, and retry...
             int retry_count = 0;
+            int retries     = MAX_RETRIES - 1;
             for (; retry_count < MAX_RETRIES; ++retry_count) {
                 // Flush the UART:
                 _uart.flush();
@@ -221,6 +262,7 @@ namespace Spindles {
 
                     // Success
                     unresponsive = false;
+                    retries      = retry_count;
                     retry_count  = MAX_RETRIES + 1;  // stop retry'ing
 
                     // Should we parse this?
@@ -275,6 +317,8 @@ namespace Spindles {
                 }
             }
 
+            record(traffic, next_cmd, retries, retry_count != MAX_RETRIES);
+
             if (retry_count == MAX_RETRIES) {
                 if (!unresponsive) {
                     grbl_msg_sendf(CLIENT_ALL, MsgLevel::Info, "Spindle RS485 Unresponsive %d", next_cmd.rx_length);
@@ -288,10 +332,70 @@ namespace Spindles {
                 }
             }
 
-            vTaskDelay(VFD_RS485_POLL_RATE / portTICK_PERIOD_MS);
+            vTaskDelay(silent_ticks);
+        }
+    }
+
+    // Takes the pending set-speed command, if there is one
+    bool VFD::take_speed_command(ModbusCommand& cmd) {
+        portENTER_CRITICAL(&speed_spinlock);
+        bool pending = speed_pending;
+        if (pending) {
+            cmd           = speed_cmd;
+            speed_pending = false;
+        }
+        portEXIT_CRITICAL(&speed_spinlock);
+        return pending;
+    }
+
+    // Wakes the task up if it is waiting for the next poll. set_rpm is also called from the stepper ISR.
+    void VFD::wake_task() {
+        if (vfd_cmdTaskHandle == nullptr) {
+            return;
+        }
+        if (xPortInIsrContext()) {
+            BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+            vTaskNotifyGiveFromISR(vfd_cmdTaskHandle, &xHigherPriorityTaskWoken);
+            if (xHigherPriorityTaskWoken == pdTRUE) {
+                portYIELD_FROM_ISR();
+            }
+        } else {
+            xTaskNotifyGive(vfd_cmdTaskHandle);
+        }
+    }
+
+    void VFD::record(Traffic traffic, const ModbusCommand& cmd, int retries, bool ok) {
+        TrafficStats& s       = stats[int(traffic)];
+        uint32_t      latency = uint32_t(esp_timer_get_time() - cmd.queued_us);
+
+        s.count++;
+        s.retries += retries;
+        if (!ok) {
+            s.failures++;
+        }
+        s.total_us += latency;
+        if (latency > s.max_us) {
+            s.max_us = latency;
+        }
+    }
+
+    void VFD::report_stats(uint8_t client) {
+        for (int traffic = 0; traffic < int(Traffic::Count); traffic++) {
+            const TrafficStats& s = stats[traffic];
+            grbl_sendf(client,
+                       "[VFD:%s,N:%u,Fail:%u,Retry:%u,Superseded:%u,Avg:%u,Max:%u]\r\n",
+                       traffic_names[traffic],
+                       s.count,
+                       s.failures,
+                       s.retries,
+                       s.superseded,
+                       s.count ? uint32_t(s.total_us / s.count) : 0,
+                       s.max_us);
         }
     }
 
+    void VFD::clear_stats() { memset(stats, 0, sizeof(stats)); }
+
     // ================== Class methods ==================================
 
     void VFD::init() {
@@ -403,7 +507,7 @@ namespace Spindles {
         bool shouldWait = state != _current_state || state != SpindleState::Disable;
         bool critical   = (sys.state == State::Cycle || state != SpindleState::Disable);
 
-        int32_t delayMillis = 1000;
+        int32_t delayMillis = 0;
 
         if (_current_state != state) {  // already at the desired state. This function gets called a lot.
             set_mode(state, critical);  // critical if we are in a job
@@ -422,10 +526,6 @@ namespace Spindles {
             } else {
                 delayMillis = _spinup_delay;
             }
-
-            if (_current_state != state && !supports_actual_rpm()) {
-                delay(delayMillis);
-            }
         } else {
             if (_current_rpm != rpm) {
                 if (rpm != 0 && (rpm < _min_rpm || rpm > _max_rpm)) {
@@ -443,55 +543,10 @@ namespace Spindles {
         }
 
         if (shouldWait) {
-            if (supports_actual_rpm()) {
-                _syncing = true;
-
-                // Allow 2.5% difference from what we asked for. Should be fine.
-                uint32_t drpm = (_max_rpm - _min_rpm) / 40;
-                if (drpm < 100) {
-                    drpm = 100;
-                }  // Just a sanity check
-
-                auto minRpmAllowed = _current_rpm > drpm ? (_current_rpm - drpm) : 0;
-                auto maxRpmAllowed = _current_rpm + drpm;
-
-                int       unchanged = 0;
-                const int limit     = 20;  // 20 * 0.5s = 10 sec
-                auto      last      = _sync_rpm;
-
-                while ((_sync_rpm < minRpmAllowed || _sync_rpm > maxRpmAllowed) && unchanged < limit) {
-#ifdef VFD_DEBUG_MODE
-                    grbl_msg_sendf(CLIENT_SERIAL, MsgLevel::Info, "Syncing RPM. Requested %d, current %d", int(rpm), int(_sync_rpm));
-#endif
-                    if (!mc_dwell(500)) {
-                        // Something happened while we were dwelling, like a safety door.
-                        unchanged = limit;
-                        last      = _sync_rpm;
-                        break;
-                    }
-
-                    if (_sync_rpm == last) {
-                        ++unchanged;
-                    } else {
-                        unchanged = 0;
-                    }
-                    last = _sync_rpm;
-                }
-
-                if (unchanged == limit) {
-                    grbl_msg_sendf(CLIENT_ALL,
-                                   MsgLevel::Error,
-                                   "Critical Spindle RS485 did not reach speed %d. Reported speed is %d rpm.",
-                                   rpm,
-                                   _sync_rpm);
-                    mc_reset();
-                    sys_rt_exec_alarm = ExecAlarm::SpindleControl;
-                }
-
-                _syncing = false;
-            } else {
-                delay(delayMillis);
-            }
+            // With the actual speed, motion continues as soon as the spindle is at speed
+            _syncing = supports_actual_rpm();
+            wait_for_speed(_current_rpm, delayMillis);
+            _syncing = false;
         }
 
         _current_state         = state;  // store locally for faster get_state()
@@ -514,14 +569,19 @@ namespace Spindles {
             if (!xQueueReset(vfd_cmd_queue)) {
                 grbl_msg_sendf(CLIENT_SERIAL, MsgLevel::Info, "VFD spindle off, queue could not be reset");
             }
+            portENTER_CRITICAL(&speed_spinlock);
+            speed_pending = false;
+            portEXIT_CRITICAL(&speed_spinlock);
         }
 
-        mode_cmd.critical = critical;
-        _current_state    = mode;
+        mode_cmd.critical  = critical;
+        mode_cmd.queued_us = esp_timer_get_time();
+        _current_state     = mode;
 
         if (xQueueSend(vfd_cmd_queue, &mode_cmd, 0) != pdTRUE) {
             grbl_msg_sendf(CLIENT_SERIAL, MsgLevel::Info, "VFD Queue Full");
         }
+        wake_task();
 
         return true;
     }
@@ -571,15 +631,32 @@ namespace Spindles {
         // spindle sync to kick in after we set the speed. This forces that.
         _sync_rpm = UINT32_MAX;
 
-        rpm_cmd.critical = (rpm == 0);
+        rpm_cmd.critical  = (rpm == 0);
+        rpm_cmd.queued_us = esp_timer_get_time();
 
-        if (xQueueSend(vfd_cmd_queue, &rpm_cmd, 0) != pdTRUE) {
-            grbl_msg_sendf(CLIENT_SERIAL, MsgLevel::Info, "VFD Queue Full");
+        // A speed that has not been sent yet is stale now, so replace it. If it was a
+        // stop, a failure to send the new speed is just as critical.
+        portENTER_CRITICAL(&speed_spinlock);
+        if (speed_pending) {
+            rpm_cmd.critical = rpm_cmd.critical || speed_cmd.critical;
+            stats[int(Traffic::Speed)].superseded++;
         }
+        speed_cmd     = rpm_cmd;
+        speed_pending = true;
+        portEXIT_CRITICAL(&speed_spinlock);
+        wake_task();
 
         return rpm;
     }
 
+    bool VFD::get_actual_rpm(uint32_t& rpm) {
+        if (!supports_actual_rpm()) {
+            return false;
+        }
+        rpm = _sync_rpm;  // UINT32_MAX until the VFD has been polled after a speed change
+        return true;
+    }
+
     void VFD::stop() {
 #ifdef VFD_DEBUG_MODE
         grbl_msg_sendf(CLIENT_SERIAL, MsgLevel::Debug, "VFD::stop()");
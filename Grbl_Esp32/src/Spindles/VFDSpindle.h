@@ -53,6 +53,8 @@ namespace Spindles {
         struct ModbusCommand {
             bool critical;  // TODO SdB: change into `uint8_t critical : 1;`: We want more flags...
 
+            int64_t queued_us;  // when the command was handed to the task, for the latency stats
+
             uint8_t tx_length;
             uint8_t rx_length;
             uint8_t msg[VFD_RS485_MAX_MSG_SIZE];
@@ -78,6 +80,34 @@ namespace Spindles {
         Uart::Stop   _stopBits;
         Uart::Parity _parity;
 
+    private:
+        // The kinds of traffic on the bus, in the order the task serves them
+        enum class Traffic : uint8_t {
+            Mode = 0,  // direction and stop commands, queued in order
+            Speed,     // only the newest set-speed command is sent
+            Init,
+            Poll,
+            Count,
+        };
+
+        struct TrafficStats {
+            uint32_t count;
+            uint32_t failures;
+            uint32_t retries;
+            uint32_t superseded;  // set-speed commands replaced before they were sent
+            uint32_t max_us;      // from queueing the command to its response
+            uint64_t total_us;
+        };
+
+        static ModbusCommand speed_cmd;
+        static bool          speed_pending;
+        static portMUX_TYPE  speed_spinlock;
+        static TrafficStats  stats[int(Traffic::Count)];
+
+        static bool take_speed_command(ModbusCommand& cmd);
+        static void wake_task();
+        static void record(Traffic traffic, const ModbusCommand& cmd, int retries, bool ok);
+
     public:
         VFD();
         VFD(const VFD&) = delete;
@@ -98,6 +128,12 @@ namespace Spindles {
         SpindleState get_state();
         uint32_t     set_rpm(uint32_t rpm);
         void         stop();
+        bool         get_actual_rpm(uint32_t& rpm) override;
+        uint32_t     min_rpm() override { return _min_rpm; }
+        uint32_t     max_rpm() override { return _max_rpm; }
+
+        static void report_stats(uint8_t client);
+        static void clear_stats();
 
         virtual ~VFD() {}
     };
@@ -34,10 +34,11 @@
 // discarded when entirely consumed and completed by the segment buffer. Also, AMASS alters this
 // data for its own use.
 typedef struct {
-    uint32_t steps[MAX_N_AXIS];
-    uint32_t step_event_count;
-    uint8_t  direction_bits;
-    uint8_t  is_pwm_rate_adjusted;  // Tracks motions that require constant laser power/rate
+    uint32_t   steps[MAX_N_AXIS];
+    uint32_t   step_event_count;
+    uint8_t    direction_bits;
+    uint8_t    is_pwm_rate_adjusted;  // Tracks motions that require constant laser power/rate
+    RasterLine raster;                // Pixel powers of a $Raster line; n_pixels is 0 for other blocks
 } st_block_t;
 static st_block_t st_block_buffer[SEGMENT_BUFFER_SIZE - 1];
 
@@ -51,6 +52,14 @@ typedef struct {
     uint8_t  st_block_index;  // Stepper block data index. Uses this information to execute this segment.
     uint8_t  amass_level;     // AMASS level for the ISR to execute this segment
     uint16_t spindle_rpm;     // TODO get rid of this.
+    // With $Laser/PowerUpdates, the laser power follows the speed inside the segment. Every
+    // spindle_interval ISR ticks, spindle_slope is added to the power; 0 leaves it alone.
+    uint16_t spindle_interval;
+    int32_t  spindle_slope;  // rpm/256 per interval
+    // In a raster block, the pixel under the laser at the first ISR tick and the distance
+    // moved per tick, both in pixels with 16 fractional bits.
+    uint32_t raster_pos;
+    uint32_t raster_inc;
 } segment_t;
 static segment_t segment_buffer[SEGMENT_BUFFER_SIZE];
 
@@ -71,6 +80,12 @@ typedef struct {
     uint8_t     exec_block_index;  // Tracks the current st_block index. Change indicates new block.
     st_block_t* exec_block;        // Pointer to the block data for the segment being executed
     segment_t*  exec_segment;      // Pointer to the segment being executed
+
+    int32_t  spindle_rpm;        // rpm/256, when the segment steps the laser power
+    uint16_t spindle_countdown;  // ISR ticks to the next laser power step
+
+    uint32_t raster_pos;    // Pixel position with 16 fractional bits
+    uint16_t raster_pixel;  // Pixel whose power is set
 } stepper_t;
 static stepper_t st;
 
@@ -220,10 +235,11 @@ void IRAM_ATTR onStepperDriverTimer(void* para) {
  * is to keep pulse timing as regular as possible.
  */
 static void stepper_pulse_func() {
-    auto n_axis = number_axis->get();
+    MotionConfigRef config;
+    auto            n_axis = config->n_axis;
 
     if (motors_direction(st.dir_outbits)) {
-        auto wait_direction = direction_delay_microseconds->get();
+        auto wait_direction = config->direction_delay_us;
         if (wait_direction > 0) {
             // Stepper drivers need some time between changing direction and doing a pulse.
             switch (current_stepper) {
@@ -284,15 +300,21 @@ static void stepper_pulse_func() {
                 st.steps[axis] = st.exec_block->steps[axis] >> st.exec_segment->amass_level;
             }
             // Set real-time spindle output as segment is loaded, just prior to the first step.
-            if (sys_rt_exec_alarm == ExecAlarm::None) {
+            // A raster block sets the power of its first pixel with the first step instead.
+            if (st.exec_block->raster.n_pixels) {
+                st.raster_pos   = st.exec_segment->raster_pos;
+                st.raster_pixel = UINT16_MAX;
+            } else if (sys_rt_exec_alarm == ExecAlarm::None) {
                 spindle->set_rpm(st.exec_segment->spindle_rpm);
             }
+            st.spindle_rpm       = int32_t(st.exec_segment->spindle_rpm) << 8;
+            st.spindle_countdown = st.exec_segment->spindle_interval;
         } else {
             // Segment buffer empty. Shutdown.
             st_go_idle();
             if (sys.state != State::Jog) {  // added to prevent ... jog after probing crash
                 // Ensure pwm is set properly upon completion of rate-controlled motion.
-                if (st.exec_block != NULL && st.exec_block->is_pwm_rate_adjusted) {
+                if (st.exec_block != NULL && (st.exec_block->is_pwm_rate_adjusted || st.exec_block->raster.n_pixels)) {
                     spindle->set_rpm(0);
                 }
             }
@@ -325,6 +347,26 @@ static void stepper_pulse_func() {
     if (sys.state == State::Homing) {
         st.step_outbits &= sys.homing_axis_lock;
     }
+    // Step the laser power within the segment
+    if (st.spindle_countdown && --st.spindle_countdown == 0) {
+        st.spindle_countdown = st.exec_segment->spindle_interval;
+        st.spindle_rpm += st.exec_segment->spindle_slope;
+        if (sys_rt_exec_alarm == ExecAlarm::None) {
+            spindle->set_rpm(st.spindle_rpm >> 8);
+        }
+    }
+    // Set the power of the raster pixel under the laser, scaled by the segment power
+    if (st.exec_block->raster.n_pixels) {
+        uint16_t pixel = st.raster_pos >> 16;
+        st.raster_pos += st.exec_segment->raster_inc;
+        if (pixel != st.raster_pixel && pixel < st.exec_block->raster.n_pixels) {
+            st.raster_pixel = pixel;
+            if (sys_rt_exec_alarm == ExecAlarm::None) {
+                spindle->set_rpm(st.exec_block->raster.pixels[pixel] * uint32_t(st.exec_segment->spindle_rpm) / 255);
+            }
+        }
+    }
+
     st.step_count--;  // Decrement step events count
     if (st.step_count == 0) {
         // Segment is complete. Discard current segment and advance segment indexing.
@@ -337,13 +379,13 @@ static void stepper_pulse_func() {
     switch (current_stepper) {
         case ST_I2S_STREAM:
             // Generate the number of pulses needed to span pulse_microseconds
-            i2s_out_push_sample(pulse_microseconds->get());
+            i2s_out_push_sample(config->pulse_us);
             motors_unstep();
             break;
         case ST_I2S_STATIC:
         case ST_TIMED:
             // wait for step pulse time to complete...some time expired during code above
-            while (esp_timer_get_time() - step_pulse_start_time < pulse_microseconds->get()) {
+            while (esp_timer_get_time() - step_pulse_start_time < config->pulse_us) {
                 NOP();  // spin here until time to turn off step
             }
             motors_unstep();
@@ -563,7 +605,7 @@ void st_prep_buffer() {
                 st_prep_block                 = &st_block_buffer[prep.st_block_index];
                 st_prep_block->direction_bits = pl_block->direction_bits;
                 uint8_t idx;
-                auto    n_axis = number_axis->get();
+                auto    n_axis = MotionConfigRef()->n_axis;
 
                 // Bit-shift multiply all Bresenham data by the max AMASS level so that
                 // we never divide beyond the original data anywhere in the algorithm.
@@ -572,6 +614,11 @@ void st_prep_buffer() {
                     st_prep_block->steps[idx] = pl_block->steps[idx] << maxAmassLevel;
                 }
                 st_prep_block->step_event_count = pl_block->step_event_count << maxAmassLevel;
+                if (pl_block->raster) {
+                    st_prep_block->raster = *pl_block->raster;
+                } else {
+                    st_prep_block->raster.n_pixels = 0;
+                }
 
                 // Initialize segment buffer data for generating the segments.
                 prep.steps_remaining  = (float)pl_block->step_event_count;
@@ -609,6 +656,7 @@ void st_prep_buffer() {
                 // Compute velocity profile parameters for a feed hold in-progress. This profile overrides
                 // the planner block profile, enforcing a deceleration to zero speed.
                 prep.ramp_type = RAMP_DECEL;
+                rt_trace_stage(RtEvent::FeedHold, RtStage::Effect);
                 // Compute decelerate distance relative to end of block.
                 float decel_dist = pl_block->millimeters - inv_2_accel * pl_block->entry_speed_sqr;
                 if (decel_dist < 0.0) {
@@ -712,6 +760,7 @@ void st_prep_buffer() {
         float speed_var;                                            // Speed worker variable
         float mm_remaining = pl_block->millimeters;                 // New segment distance from end of block.
         float minimum_mm   = mm_remaining - prep.req_mm_increment;  // Guarantee at least one step.
+        float entry_speed  = prep.current_speed;                    // Speed at the start of the segment
 
         if (minimum_mm < 0.0) {
             minimum_mm = 0.0;
@@ -801,11 +850,16 @@ void st_prep_buffer() {
         /* -----------------------------------------------------------------------------------
           Compute spindle speed PWM output for step segment
         */
-        if (st_prep_block->is_pwm_rate_adjusted || sys.step_control.updateSpindleRpm) {
+        float rpm_change = 0.0;  // over the segment, from entry_speed to current_speed
+        if (st_prep_block->is_pwm_rate_adjusted || sys.step_control.updateSpindleRpm || pl_block->surface_speed > 0) {
             if (pl_block->spindle != SpindleState::Disable) {
                 float rpm = pl_block->spindle_speed;
+                if (pl_block->surface_speed > 0) {
+                    rpm = plan_surface_speed_rpm(pl_block, mm_remaining);  // G96, where the segment ends
+                }
                 // NOTE: Feed and rapid overrides are independent of PWM value and do not alter laser power/rate.
                 if (st_prep_block->is_pwm_rate_adjusted) {
+                    rpm_change = rpm * (prep.current_speed - entry_speed) * prep.inv_rate;
                     rpm *= (prep.current_speed * prep.inv_rate);
                     //grbl_msg_sendf(CLIENT_SERIAL, MsgLevel::Info, "RPM %.2f", rpm);
                     //grbl_msg_sendf(CLIENT_SERIAL, MsgLevel::Info, "Rates CV %.2f IV %.2f RPM %.2f", prep.current_speed, prep.inv_rate, rpm);
@@ -820,7 +874,8 @@ void st_prep_buffer() {
             }
             sys.step_control.updateSpindleRpm = false;
         }
-        prep_segment->spindle_rpm = prep.current_spindle_rpm;  // Reload segment PWM value
+        prep_segment->spindle_rpm      = prep.current_spindle_rpm;  // Reload segment PWM value
+        prep_segment->spindle_interval = 0;
 
         /* -----------------------------------------------------------------------------------
            Compute segment step rate, steps to execute, and apply necessary rate corrections.
@@ -884,6 +939,30 @@ void st_prep_buffer() {
         // largest value that will fit in a uint16_t.
         prep_segment->isrPeriod = timerTicks > 0xffff ? 0xffff : timerTicks;
 
+        // On a ramp, the power set above lags the speed by up to a segment. Instead, split the
+        // segment into equal parts, start at the power for the middle of the first part and
+        // step by the same amount at the start of every other part. The ISR ticks are evenly
+        // spaced in a segment, so the power follows the speed.
+        int32_t power_updates = MotionConfigRef()->laser_power_updates;
+        if (rpm_change != 0.0 && power_updates > 1 && prep_segment->n_step > 1 && !st_prep_block->raster.n_pixels) {
+            uint16_t interval = prep_segment->n_step / power_updates;
+            if (interval == 0) {
+                interval = 1;
+            }
+            float slope                    = rpm_change / (prep_segment->n_step / interval);
+            prep_segment->spindle_rpm      = prep.current_spindle_rpm - rpm_change + 0.5 * slope;
+            prep_segment->spindle_slope    = slope * 256.0;
+            prep_segment->spindle_interval = interval;
+        }
+
+        // The pixels of a raster line are spread evenly over the step events of its block.
+        if (st_prep_block->raster.n_pixels) {
+            float pixels_per_step    = float(st_prep_block->raster.n_pixels) / pl_block->step_event_count;
+            float steps_done         = pl_block->step_event_count - last_n_steps_remaining;
+            prep_segment->raster_pos = steps_done * pixels_per_step * 65536.0;
+            prep_segment->raster_inc = pixels_per_step * 65536.0 / (1 << level);
+        }
+
         // Segment complete! Increment segment buffer indices, so stepper ISR can immediately execute it.
         segment_buffer_head = segment_next_head;
         if (++segment_next_head == SEGMENT_BUFFER_SIZE) {
@@ -169,7 +169,7 @@ void system_flag_wco_change() {
 
 float system_convert_axis_steps_to_mpos(int32_t* steps, uint8_t idx) {
     float pos;
-    float steps_per_mm = axis_settings[idx]->steps_per_mm->get();
+    float steps_per_mm = MotionConfigRef()->steps_per_mm[idx];
     pos                = steps[idx] / steps_per_mm;
     return pos;
 }
@@ -178,10 +178,11 @@ float system_convert_axis_steps_to_mpos(int32_t* steps, uint8_t idx) {
 // NOTE: If motor steps and machine position are not in the same coordinate frame, this function
 //   serves as a central place to compute the transformation.
 void system_convert_array_steps_to_mpos(float* position, int32_t* steps) {
-    auto  n_axis = number_axis->get();
-    float motors[n_axis];
+    MotionConfigRef config;
+    auto            n_axis = config->n_axis;
+    float           motors[n_axis];
     for (int idx = 0; idx < n_axis; idx++) {
-        motors[idx] = (float)steps[idx] / axis_settings[idx]->steps_per_mm->get();
+        motors[idx] = (float)steps[idx] / config->steps_per_mm[idx];
     }
     motors_to_cartesian(position, motors, n_axis);
 }
@@ -372,4 +373,5 @@ void __attribute__((weak)) user_defined_macro(uint8_t index) {
     user_macro.toCharArray(line, 255, 0);
     strcat(line, "\r");
     WebUI::inputBuffer.push(line);
+    client_notify();
 }
@@ -11,9 +11,11 @@
 #include "soc/dport_reg.h"
 #include "soc/rtc.h"
 
-Uart::Uart(int uart_num) : _uart_num(uart_port_t(uart_num)), _pushback(-1) {}
+Uart::Uart(int uart_num) : _uart_num(uart_port_t(uart_num)), _pushback(-1), _event_queue(NULL), _rx_buffer_size(256) {}
 
-void Uart::begin(unsigned long baudrate, Data dataBits, Stop stopBits, Parity parity) {
+// If eventQueueSize is nonzero, the driver posts RX events to eventQueue() so
+// a task can block until data arrives instead of polling.
+void Uart::begin(unsigned long baudrate, Data dataBits, Stop stopBits, Parity parity, int eventQueueSize) {
     //    uart_driver_delete(_uart_num);
     uart_config_t conf;
     conf.baud_rate           = baudrate;
@@ -26,7 +28,7 @@ void Uart::begin(unsigned long baudrate, Data dataBits, Stop stopBits, Parity pa
     if (uart_param_config(_uart_num, &conf) != ESP_OK) {
         return;
     };
-    uart_driver_install(_uart_num, 256, 0, 0, NULL, 0);
+    uart_driver_install(_uart_num, _rx_buffer_size, 0, eventQueueSize, eventQueueSize ? &_event_queue : NULL, 0);
 }
 
 int Uart::available() {
@@ -87,6 +89,11 @@ bool Uart::setHalfDuplex() {
 bool Uart::setPins(int tx_pin, int rx_pin, int rts_pin, int cts_pin) {
     return uart_set_pin(_uart_num, tx_pin, rx_pin, rts_pin, cts_pin) != ESP_OK;
 }
+// Enables RTS/CTS. RTS is deasserted when the hardware FIFO holds rx_threshold
+// bytes, which happens once the driver's RX buffer is full and stops draining it.
+bool Uart::setHwFlowControl(uint8_t rx_threshold) {
+    return uart_set_hw_flow_ctrl(_uart_num, UART_HW_FLOWCTRL_CTS_RTS, rx_threshold) != ESP_OK;
+}
 bool Uart::flushTxTimed(TickType_t ticks) {
     return uart_wait_tx_done(_uart_num, ticks) != ESP_OK;
 }
@@ -4,8 +4,10 @@
 
 class Uart : public Stream {
 private:
-    uart_port_t _uart_num;
-    int         _pushback;
+    uart_port_t   _uart_num;
+    int           _pushback;
+    QueueHandle_t _event_queue;
+    int           _rx_buffer_size;
 
 public:
     enum class Data : int {
@@ -30,7 +32,11 @@ public:
     Uart(int uart_num);
     bool          setHalfDuplex();
     bool          setPins(int tx_pin, int rx_pin, int rts_pin = -1, int cts_pin = -1);
-    void          begin(unsigned long baud, Data dataBits, Stop stopBits, Parity parity);
+    void          setRxBufferSize(int size) { _rx_buffer_size = size; }  // Call before begin()
+    int           rxBufferSize() const { return _rx_buffer_size; }
+    bool          setHwFlowControl(uint8_t rx_threshold);
+    void          begin(unsigned long baud, Data dataBits, Stop stopBits, Parity parity, int eventQueueSize = 0);
+    QueueHandle_t eventQueue() const { return _event_queue; }
     int           available(void) override;
     int           read(void) override;
     int           read(TickType_t timeout);
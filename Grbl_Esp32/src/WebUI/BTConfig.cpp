@@ -54,6 +54,9 @@ namespace WebUI {
                 grbl_send(CLIENT_ALL, "[MSG:BT Disconnected]\r\n");
                 BTConfig::_btclient = "";
                 break;
+            case ESP_SPP_DATA_IND_EVT:  // Data was queued by BluetoothSerial
+                client_notify();
+                break;
             default:
                 break;
         }
@@ -67,6 +67,7 @@ namespace WebUI {
      */
     void COMMANDS::restart_ESP() {
         restart_ESP_module = true;
+        client_notify();  // The client task performs the restart
     }
 
     /**
@@ -76,6 +77,7 @@ namespace WebUI {
         COMMANDS::wait(0);
         //in case of restart requested
         if (restart_ESP_module) {
+            client_flush_tx(500);
             ESP.restart();
             while (1) {}
         }
@@ -515,6 +515,7 @@ namespace WebUI {
                 if (!Serial2Socket.push(scmd.c_str())) {
                     hasError = true;
                 }
+                client_notify();
             }
             _webserver->send(200, "text/plain", hasError?"Error":"");
         }
@@ -738,9 +738,32 @@ namespace WebUI {
             webPrintln("Busy");
             return Error::IdleError;
         }
+        // An optional ",line" suffix resumes the job at that line
+        uint32_t start_line = 0;
+        char*    comma      = strrchr(parameter, ',');
+        if (comma) {
+            *comma = '\0';
+            char* end;
+            start_line = strtoul(comma + 1, &end, 10);
+            if (end == comma + 1 || *trim(end) != '\0') {
+                webPrintln("Invalid line number!");
+                return Error::InvalidValue;
+            }
+        }
         if ((err = openSDFile(parameter)) != Error::Ok) {
             return err;
         }
+        SD_client     = (espresponse) ? espresponse->client() : CLIENT_ALL;
+        SD_auth_level = auth_level;
+        if (start_line > 1) {
+            if ((err = sd_seek_line(start_line)) != Error::Ok) {
+                closeFile();
+                webPrintln("");
+                return err;
+            }
+        } else {
+            sd_index_start();
+        }
         char fileLine[255];
         if (!readFileLine(fileLine, 255)) {
             //No need notification here it is just a macro
@@ -748,8 +771,6 @@ namespace WebUI {
             webPrintln("");
             return Error::Ok;
         }
-        SD_client     = (espresponse) ? espresponse->client() : CLIENT_ALL;
-        SD_auth_level = auth_level;
         // execute the first line now; Protocol.cpp handles later ones when SD_ready_next
         report_status_message(execute_line(fileLine, SD_client, SD_auth_level), SD_client);
         report_realtime_status(SD_client);
@@ -1091,7 +1112,7 @@ namespace WebUI {
 #endif
 #ifdef ENABLE_SD_CARD
         new WebCommand("path", WEBCMD, WU, "ESP221", "SD/Show", showSDFile);
-        new WebCommand("path", WEBCMD, WU, "ESP220", "SD/Run", runSDFile);
+        new WebCommand("path[,line]", WEBCMD, WU, "ESP220", "SD/Run", runSDFile);
         new WebCommand("file_or_directory_path", WEBCMD, WU, "ESP215", "SD/Delete", deleteSDObject);
         new WebCommand(NULL, WEBCMD, WU, "ESP210", "SD/List", listSDFiles);
 #endif
@@ -111,15 +111,11 @@ USAGE:
     model solution is more accurate in the region that the spindle typically running. 
     Re-run the script and tweak the junction points until you are satified with the model.
     
-  - Record the solution and enter the RPM_POINT and RPM_LINE values into config.h. Set the 
-    number of piecewise lines used in this model in config.h. Also set the '$30' and '$31'
-    max and min rpm values to the solution values or in a range between them in Grbl '$' 
-    settings. And finally, alter the SPINDLE_PWM_MIN_VALUE in cpu_map.h, if your spindle 
-    needs to be above a certain voltage to produce a useful low rpm.
-    
-  - Once the solution is entered. Recompile and flash Grbl. This solution model is only 
-    valid for this particular set of data. If the machine is altered, you will need to 
-    perform this experiment again and regenerate a new model here. 
+  - Record the solution and enter the $Spindle/PWM/Map line it prints into Grbl. Also set 
+    the '$30' and '$31' max and min rpm values to the solution values or in a range between 
+    them in Grbl '$' settings. No recompile is needed. This solution model is only valid 
+    for this particular set of data. If the machine is altered, you will need to perform 
+    this experiment again and regenerate a new model here. 
   
 OUTPUT: 
   The solver produces a set of values that define the piecewise fit and can be used by 
@@ -135,15 +131,13 @@ OUTPUT:
   at 8000 rpm. In other words, Grbl will only output voltages the range between 
   max(RPM_MIN,$31) and min(RPM_MAX,$30).
         
-  The remaining values define the slopes and offsets of the line segments and the junction 
-  points between line segments, like so for n_pieces=3:
+  The map is the list of 'rpm:percent' junction points of the line segments, where 
+  percent is the PWM duty. Grbl draws straight lines between the points, like so for 
+  n_pieces=3, and expands them into a table when the spindle starts:
         
-    PWM_output = RPM_LINE_A1 * rpm - RPM_LINE_B1     [ RPM_MIN < rpm < RPM_POINT12 ]
-    PWM_output = RPM_LINE_A2 * rpm - RPM_LINE_B2     [ RPM_POINT12 < rpm < RPM_POINT23 ]
-    PWM_output = RPM_LINE_A3 * rpm - RPM_LINE_B3     [ RPM_POINT23 < rpm < RPM_MAX ]
+    rpm[0]:pwm[0], rpm[1]:pwm[1], rpm[2]:pwm[2], rpm[3]:pwm[3]
     
-  NOTE: The script solves in terms of PWM but the final equations and values are expressed 
-  in terms of rpm in the form 'PWM = a*rpm - b'. 
+  $34-$36 are not used while a map is set. Clear it with '$Spindle/PWM/Map=' to go back.
 
 """
 
@@ -300,44 +294,18 @@ else :
   print("ERROR: Unsupported number of pieces. Check and alter n_pieces")
   quit()
 
-print("\nSOLUTION:\n\n[Update these #define values and uncomment]\n[ENABLE_PIECEWISE_LINEAR_SPINDLE in config.h.]")
-print("#define N_PIECES %.0f" % n_pieces)
-print("#define RPM_MAX %.1f" % rpm[-1])
-print("#define RPM_MIN %.1f" % rpm[0])
+# Duty of each junction point, in percent of the full 'S' range of the data
+PWM_knots = [PWM_min, PWM_point1, PWM_point2, PWM_point3][:n_pieces] + [PWM_max]
+spindle_map = ",".join("%.0f:%.2f" % (r, k / 2.55) for r, k in zip(rpm, PWM_knots))
 
-if n_pieces > 1:
-  print("#define RPM_POINT12 %.1f" % rpm[1])
-if n_pieces > 2:
-  print("#define RPM_POINT23 %.1f" %rpm[2])
-if n_pieces > 3:
-  print("#define RPM_POINT34 %.1f" %rpm[3])
-
-print("#define RPM_LINE_A1 %.6e" % (1./a[0]))
-print("#define RPM_LINE_B1 %.6e" % (b[0]/a[0]))
-if n_pieces > 1:
-  print("#define RPM_LINE_A2 %.6e" % (1./a[1]))
-  print("#define RPM_LINE_B2 %.6e" % (b[1]/a[1]))
-if n_pieces > 2:
-  print("#define RPM_LINE_A3 %.6e" % (1./a[2]))
-  print("#define RPM_LINE_B3 %.6e" % (b[2]/a[2]))
-if n_pieces > 3:
-  print("#define RPM_LINE_A4 %.6e" % (1./a[3]))
-  print("#define RPM_LINE_B4 %.6e" % (b[3]/a[3]))
+print("\nSOLUTION:\n\n[Enter this setting into Grbl]")
+print("$Spindle/PWM/Map=%s" % spindle_map)
 
 print("\n[To operate over full model range, manually write these]")
 print("['$' settings or alter values in defaults.h. Grbl will]")
 print("[operate between min($30,RPM_MAX) and max($31,RPM_MIN)]")
 print("$30=%.1f (rpm max)" % rpm[-1])
 print("$31=%.1f (rpm min)" % rpm[0])
-
-if (PWM_min > 1)|(PWM_max<255):
-  print("\n[Update the following #define values in cpu_map.h]")
-  if (PWM_min >1) :
-    print("#define SPINDLE_PWM_MIN_VALUE %.0f" % PWM_min)
-  if PWM_max <255:
-    print("#define SPINDLE_PWM_MAX_VALUE %.0f" % PWM_max)
-else:
-  print("\n[No cpu_map.h changes required.]")
 print("\n")
 
 test_val = (1./a[0])*rpm[0] - (b[0]/a[0])
@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+"""\
+Converts an image into $Raster lines for laser engraving
+
+Each image row becomes one or more $Raster lines, scanned in alternate
+directions. Dark pixels get more power; 255 in a line is the S value of the
+M3 or M4 that comes before it. Needs Pillow.
+
+  raster_image.py photo.png photo.nc --width 50 --feed 3000 --power 1000
+"""
+
+import argparse
+import base64
+
+from PIL import Image
+
+MAX_PIXELS = 162  # Fits the default 256 character line buffer
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("image")
+    parser.add_argument("output")
+    parser.add_argument("--width", type=float, required=True, help="engraving width in mm")
+    parser.add_argument("--pitch", type=float, default=0.1, help="pixel size in mm")
+    parser.add_argument("--feed", type=float, default=3000.0, help="mm/min")
+    parser.add_argument("--power", type=int, default=1000, help="S value for black")
+    parser.add_argument("--laser-mode", choices=("M3", "M4"), default="M4")
+    args = parser.parse_args()
+
+    image = Image.open(args.image).convert("L")
+    columns = round(args.width / args.pitch)
+    rows = round(image.height * columns / image.width)
+    image = image.resize((columns, rows))
+
+    with open(args.output, "w") as out:
+        out.write("G21 G90\n%s S%d\n" % (args.laser_mode, args.power))
+        for row in range(rows):
+            y = (rows - 1 - row) * args.pitch
+            power = [255 - image.getpixel((column, row)) for column in range(columns)]
+            reverse = row % 2 == 1
+            if reverse:
+                power.reverse()
+            step = -args.pitch if reverse else args.pitch
+            x = columns * args.pitch if reverse else 0.0
+            for start in range(0, columns, MAX_PIXELS):
+                chunk = bytes(power[start:start + MAX_PIXELS])
+                out.write("$Raster=%.3f,%.3f,%.4f,0,%.0f,%s\n" %
+                          (x, y, step, args.feed, base64.b64encode(chunk).decode()))
+                x += step * len(chunk)
+        out.write("M5\n")
+
+
+if __name__ == "__main__":
+    main()
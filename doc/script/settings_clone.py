@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""\
+Copies all stored settings between Grbl_ESP32 machines
+
+Uses $Settings/Export and $Settings/Import over telnet (or a serial port
+with --serial, which needs pyserial). The image holds every stored setting,
+coordinate system and tool table entry, and is checked with a CRC on import.
+The target has to be restarted afterwards to use the new settings.
+
+  settings_clone.py export 192.168.0.1 machine.snap
+  settings_clone.py import 192.168.0.2 machine.snap
+  settings_clone.py clone 192.168.0.1 192.168.0.2
+  settings_clone.py export /dev/ttyUSB0 machine.snap --serial
+"""
+
+import argparse
+import re
+import socket
+import struct
+import time
+
+HEADER = struct.Struct("<IHHI")
+MAGIC = 0x50414E53
+CHUNK = 64
+
+
+class Link:
+    def __init__(self, target, serial_port, baud):
+        if serial_port:
+            import serial
+            self.port = serial.Serial(target, baud, timeout=0.1)
+            self.read = lambda: self.port.read(256)
+            self.write = self.port.write
+        else:
+            host, _, port = target.partition(":")
+            self.sock = socket.create_connection((host, int(port or 23)))
+            self.sock.settimeout(0.1)
+            self.read = self._sock_read
+            self.write = self.sock.sendall
+        self.buffer = b""
+
+    def _sock_read(self):
+        try:
+            return self.sock.recv(256)
+        except socket.timeout:
+            return b""
+
+    def line(self, timeout=5.0):
+        deadline = time.time() + timeout
+        while b"\n" not in self.buffer:
+            if time.time() > deadline:
+                raise TimeoutError("no response")
+            self.buffer += self.read()
+        line, _, self.buffer = self.buffer.partition(b"\n")
+        return line.decode(errors="replace").strip()
+
+    def command(self, text):
+        """Sends a line and returns the lines before its ok"""
+        self.write(text.encode() + b"\n")
+        lines = []
+        while True:
+            line = self.line()
+            if line == "ok":
+                return lines
+            if line.startswith("error"):
+                raise RuntimeError("%s: %s" % (text[:40], line))
+            if line:
+                lines.append(line)
+
+
+def describe(image):
+    magic, version, crc, length = HEADER.unpack_from(image)
+    if magic != MAGIC or length != len(image) - HEADER.size:
+        raise ValueError("not a settings image")
+    return "%d bytes, version %d, crc %04X" % (len(image), version, crc)
+
+
+def export(link):
+    chunks = {}
+    for line in link.command("$Settings/Export"):
+        match = re.match(r"\[SNAPSHOT:(\d+),([0-9A-F]*)\]", line)
+        if match:
+            chunks[int(match.group(1))] = bytes.fromhex(match.group(2))
+    image = b"".join(chunks[offset] for offset in sorted(chunks))
+    print("exported", describe(image))
+    return image
+
+
+def import_(link, image):
+    print("importing", describe(image))
+    for offset in range(0, len(image), CHUNK):
+        link.command("$Settings/Import=%d,%s" % (offset, image[offset:offset + CHUNK].hex().upper()))
+    print("done; restart the machine to use the new settings")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("mode", choices=("export", "import", "clone"))
+    parser.add_argument("target", help="host[:port] or, with --serial, a serial port")
+    parser.add_argument("other", help="image file, or for clone the machine to copy to")
+    parser.add_argument("--serial", action="store_true")
+    parser.add_argument("--baud", type=int, default=115200)
+    args = parser.parse_args()
+
+    link = Link(args.target, args.serial, args.baud)
+    if args.mode == "export":
+        with open(args.other, "wb") as f:
+            f.write(export(link))
+    elif args.mode == "import":
+        with open(args.other, "rb") as f:
+            import_(link, f.read())
+    else:
+        import_(Link(args.other, args.serial, args.baud), export(link))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,239 @@
+#!/usr/bin/env python3
+"""\
+Decoder and checker for the binary status frame ($Report/Binary=ON)
+
+Connects to Grbl_ESP32 over telnet (or a serial port with --serial, which
+needs pyserial) and either
+
+  check    asks for a text and a binary report back to back, decodes the
+           frame and compares it with the text report. Run it with the
+           machine idle so both describe the same position.
+  monitor  turns on binary automatic reports at --interval ms and prints
+           every decoded frame.
+
+The frame layout is status_frame_t in Grbl_Esp32/src/Report.h.
+
+  status_frame.py check 192.168.0.1
+  status_frame.py monitor 192.168.0.1 --interval 20
+  status_frame.py check /dev/ttyUSB0 --serial
+"""
+
+import argparse
+import re
+import socket
+import struct
+import sys
+import time
+
+SYNC = b"\xa5\x5a"
+FRAME = struct.Struct("<2sBBIBBBBBBHIIfI6iH")
+FIELDS = ("sync", "length", "version", "timestamp_ms", "state", "n_axis",
+          "feed_ovr", "rapid_ovr", "spindle_ovr", "planner_free", "rx_free",
+          "pins", "line_number", "feed_rate", "spindle_rpm",
+          "steps", "crc")
+STATES = ("Idle", "Alarm", "Check", "Home", "Run", "Hold", "Jog", "Door", "Sleep")
+AXES = "XYZABC"
+CONTROL_PINS = "DRHS0123"
+
+
+def crc16_ccitt(data, crc=0xFFFF):
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def decode(raw):
+    """Returns the frame as a dict, or raises ValueError"""
+    values = FRAME.unpack(raw)
+    frame = dict(zip(FIELDS[:15], values[:15]))
+    frame["steps"] = list(values[15:21])
+    frame["crc"] = values[21]
+    if frame["version"] != 1:
+        raise ValueError("unknown frame version %d" % frame["version"])
+    if frame["length"] != FRAME.size - 3:
+        raise ValueError("bad frame length %d" % frame["length"])
+    crc = crc16_ccitt(raw[3:FRAME.size - 2])
+    if crc != frame["crc"]:
+        raise ValueError("crc %04x, expected %04x" % (frame["crc"], crc))
+    return frame
+
+
+def pins_text(pins, n_axis):
+    text = "P" if pins & 0x100 else ""
+    text += "".join(AXES[i] for i in range(n_axis) if pins & (1 << i))
+    text += "".join(CONTROL_PINS[i] for i in range(8) if pins & (1 << (16 + i)))
+    return text
+
+
+class Link:
+    """Splits the byte stream into text lines and binary frames"""
+
+    def __init__(self, target, serial_port, baud):
+        if serial_port:
+            import serial
+            self.port = serial.Serial(target, baud, timeout=0.1)
+            self.read = lambda: self.port.read(256)
+            self.write = self.port.write
+        else:
+            host, _, port = target.partition(":")
+            self.sock = socket.create_connection((host, int(port or 23)))
+            self.sock.settimeout(0.1)
+            self.read = self._sock_read
+            self.write = self.sock.sendall
+        self.buffer = b""
+
+    def _sock_read(self):
+        try:
+            return self.sock.recv(256)
+        except socket.timeout:
+            return b""
+
+    def send(self, line):
+        self.write(line.encode() + (b"" if line == "?" else b"\n"))
+
+    def next(self, timeout=2.0):
+        """Returns ("line", str) or ("frame", bytes)"""
+        deadline = time.time() + timeout
+        while True:
+            sync = self.buffer.find(SYNC)
+            newline = self.buffer.find(b"\n")
+            if sync >= 0 and (newline < 0 or sync < newline):
+                if len(self.buffer) >= sync + FRAME.size:
+                    raw = self.buffer[sync:sync + FRAME.size]
+                    self.buffer = self.buffer[:sync] + self.buffer[sync + FRAME.size:]
+                    return "frame", raw
+            elif newline >= 0:
+                line = self.buffer[:newline].decode(errors="replace").strip()
+                self.buffer = self.buffer[newline + 1:]
+                if line:
+                    return "line", line
+                continue
+            if time.time() > deadline:
+                raise TimeoutError("no response")
+            self.buffer += self.read()
+
+    def command(self, line):
+        """Sends a $ command and returns the lines before its ok"""
+        self.send(line)
+        lines = []
+        while True:
+            kind, value = self.next()
+            if kind != "line":
+                continue
+            if value == "ok":
+                return lines
+            if value.startswith("error"):
+                raise RuntimeError("%s: %s" % (line, value))
+            lines.append(value)
+
+
+def read_settings(link):
+    settings = {}
+    for line in link.command("$$"):
+        match = re.match(r"\$(\d+)=(\S+)", line)
+        if match:
+            settings[int(match.group(1))] = match.group(2)
+    return settings
+
+
+def wait_for(link, kind):
+    while True:
+        got, value = link.next()
+        if got == kind and (kind == "frame" or value.startswith("<")):
+            return value
+
+
+def check(link, samples):
+    settings = read_settings(link)
+    steps_per_mm = [float(settings.get(100 + axis, 1)) for axis in range(6)]
+    inches = settings.get(13) == "1"
+    failures = 0
+    for _ in range(samples):
+        link.command("$Report/Binary=OFF")
+        link.send("?")
+        text = wait_for(link, "line")
+        link.command("$Report/Binary=ON")
+        link.send("?")
+        frame = decode(wait_for(link, "frame"))
+        link.command("$Report/Binary=OFF")
+
+        fields = dict(f.split(":", 1) if ":" in f else (f, "") for f in text.strip("<>").split("|"))
+        state = text.strip("<>").split("|")[0].split(":")[0]
+        problems = []
+        if STATES[frame["state"]] != state:
+            problems.append("state %s != %s" % (STATES[frame["state"]], state))
+        if "MPos" in fields:
+            scale = 25.4 if inches else 1.0
+            reported = [float(v) for v in fields["MPos"].split(",")]
+            for axis, value in enumerate(reported):
+                mm = frame["steps"][axis] / steps_per_mm[axis] / scale
+                if abs(mm - value) > 1.5 / steps_per_mm[axis] + 0.001:
+                    problems.append("%s %.4f != %.4f" % (AXES[axis], mm, value))
+        if "Ov" in fields:
+            ov = [int(v) for v in fields["Ov"].split(",")]
+            if ov != [frame["feed_ovr"], frame["rapid_ovr"], frame["spindle_ovr"]]:
+                problems.append("Ov %s" % fields["Ov"])
+        if "Pn" in fields and pins_text(frame["pins"], frame["n_axis"]) != fields["Pn"]:
+            problems.append("Pn %s != %s" % (pins_text(frame["pins"], frame["n_axis"]), fields["Pn"]))
+        if "FS" in fields:
+            rpm = int(fields["FS"].split(",")[1])
+            if rpm != frame["spindle_rpm"]:
+                problems.append("rpm %d != %d" % (frame["spindle_rpm"], rpm))
+        print(text)
+        print("  frame %d bytes, %s" % (FRAME.size, "OK" if not problems else "; ".join(problems)))
+        failures += bool(problems)
+    print("%d of %d samples disagree" % (failures, samples))
+    return failures == 0
+
+
+def monitor(link, interval):
+    link.command("$Report/Binary=ON")
+    link.command("$Report/Interval=%d" % interval)
+    last = None
+    try:
+        while True:
+            kind, value = link.next(timeout=10)
+            if kind == "line":
+                print(value)
+                continue
+            try:
+                frame = decode(value)
+            except ValueError as error:
+                print("bad frame:", error)
+                continue
+            dt = "" if last is None else "%+5d ms" % (frame["timestamp_ms"] - last)
+            last = frame["timestamp_ms"]
+            print("%10d %s %-5s steps=%s F=%.0f S=%d Ov=%d,%d,%d Bf=%d,%d Ln=%d Pn=%s" % (
+                frame["timestamp_ms"], dt, STATES[frame["state"]],
+                frame["steps"][:frame["n_axis"]], frame["feed_rate"], frame["spindle_rpm"],
+                frame["feed_ovr"], frame["rapid_ovr"], frame["spindle_ovr"],
+                frame["planner_free"], frame["rx_free"], frame["line_number"],
+                pins_text(frame["pins"], frame["n_axis"])))
+    except KeyboardInterrupt:
+        pass
+    finally:
+        link.command("$Report/Interval=0")
+        link.command("$Report/Binary=OFF")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("mode", choices=("check", "monitor"))
+    parser.add_argument("target", help="host[:port] or, with --serial, a serial port")
+    parser.add_argument("--serial", action="store_true")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--samples", type=int, default=5)
+    parser.add_argument("--interval", type=int, default=20, help="ms between frames in monitor mode")
+    args = parser.parse_args()
+
+    link = Link(args.target, args.serial, args.baud)
+    if args.mode == "check":
+        sys.exit(0 if check(link, args.samples) else 1)
+    monitor(link, args.interval)
+
+
+if __name__ == "__main__":
+    main()
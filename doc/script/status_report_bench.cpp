@@ -0,0 +1,143 @@
+// Host benchmark for the realtime status report builder.
+//
+// Builds a 6 axis status report with every optional field, once the way
+// report_realtime_status() used to (strcat and sprintf) and once with
+// ReportWriter, and prints the time per report and the output of each.
+//
+//   g++ -O2 -std=c++11 -I../../Grbl_Esp32/src status_report_bench.cpp -o status_report_bench
+//   ./status_report_bench
+//
+// The ESP32 is roughly 10-20x slower than a desktop core for this kind of
+// code, so scale the numbers accordingly.
+
+#include "ReportWriter.h"
+
+#include <chrono>
+#include <cstdio>
+
+static const int   n_axis       = 6;
+static float       mpos[n_axis] = { 123.456f, -78.9f, -12.3456f, 90.0f, 0.001f, 359.999f };
+static float       wco[n_axis]  = { 10.0f, 20.0f, -5.5f, 0.0f, 0.0f, 0.0f };
+static const char* filename     = "/job_with_a_fairly_long_file_name.nc";
+
+static void legacy_axis_values(const float* values, char* rpt) {
+    char axisVal[20];
+    rpt[0] = '\0';
+    for (int idx = 0; idx < n_axis; idx++) {
+        snprintf(axisVal, 19, "%4.3f", values[idx]);
+        strcat(rpt, axisVal);
+        if (idx < n_axis - 1) {
+            strcat(rpt, ",");
+        }
+    }
+}
+
+static size_t legacy_report(char* status) {
+    char temp[n_axis * 20];
+    strcpy(status, "<");
+    strcat(status, "Run");
+    strcat(status, "|MPos:");
+    legacy_axis_values(mpos, temp);
+    strcat(status, temp);
+    sprintf(temp, "|Bf:%d,%d", 15, 1023);
+    strcat(status, temp);
+    sprintf(temp, "|FS:%.0f,%d", 1500.0f, 12000);
+    strcat(status, temp);
+    strcat(status, "|R:");
+    strcat(status, "L");
+    strcat(status, "|Pn:");
+    strcat(status, "X");
+    strcat(status, "Z");
+    strcat(status, "|WCO:");
+    legacy_axis_values(wco, temp);
+    strcat(status, temp);
+    sprintf(temp, "|Ov:%d,%d,%d", 100, 100, 100);
+    strcat(status, temp);
+    strcat(status, "|A:");
+    strcat(status, "S");
+    strcat(status, "F");
+    sprintf(temp, "|SD:%4.2f,", 42.42f);
+    strcat(status, temp);
+    strcat(status, filename);
+    strcat(status, ">\r\n");
+    return strlen(status);
+}
+
+static size_t writer_report(char* status, size_t size) {
+    ReportWriter rw(status, size, 3);
+    rw.add('<');
+    rw.add("Run");
+    rw.add_label("|MPos:");
+    for (int idx = 0; idx < n_axis; idx++) {
+        if (idx) {
+            rw.add(',');
+        }
+        rw.add_fixed(mpos[idx], 3);
+    }
+    rw.add_label("|Bf:");
+    rw.add_int(15);
+    rw.add(',');
+    rw.add_int(1023);
+    rw.add_label("|FS:");
+    rw.add_fixed(1500.0f, 0);
+    rw.add(',');
+    rw.add_uint(12000);
+    rw.add_label("|R:");
+    rw.add('L');
+    rw.add_label("|Pn:");
+    rw.add('X');
+    rw.add('Z');
+    rw.add_label("|WCO:");
+    for (int idx = 0; idx < n_axis; idx++) {
+        if (idx) {
+            rw.add(',');
+        }
+        rw.add_fixed(wco[idx], 3);
+    }
+    rw.add_label("|Ov:");
+    rw.add_uint(100);
+    rw.add(',');
+    rw.add_uint(100);
+    rw.add(',');
+    rw.add_uint(100);
+    rw.add_label("|A:");
+    rw.add('S');
+    rw.add('F');
+    rw.add_label("|SD:");
+    rw.add_fixed(42.42f, 2);
+    rw.add(',');
+    rw.add(filename);
+    rw.finish(">\r\n");
+    return rw.length();
+}
+
+template <typename F>
+static double time_ns(F build, int iterations) {
+    volatile size_t sink  = 0;
+    auto            start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        mpos[0] += 0.001f;  // keep the compiler from hoisting the work
+        sink += build();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+int main() {
+    const int iterations = 200000;
+    char      legacy[512];
+    char      writer[256];
+
+    double legacy_ns = time_ns([&] { return legacy_report(legacy); }, iterations);
+    double writer_ns = time_ns([&] { return writer_report(writer, sizeof(writer)); }, iterations);
+
+    printf("legacy strcat/sprintf: %8.1f ns/report  %s", legacy_ns, legacy);
+    printf("ReportWriter:          %8.1f ns/report  %s", writer_ns, writer);
+    printf("speedup:               %8.1fx\n", legacy_ns / writer_ns);
+
+    // A report that does not fit is cut short but still terminated
+    char small[48];
+    writer_report(small, sizeof(small));
+    printf("truncated:             %s", small);
+    return 0;
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+// Stands in for Grbl_Esp32/src/Grbl.h when vfd_sim.py builds the VFD spindles
+// on the host. It declares only what VFDSpindle.cpp, Spindle.h and the RS485
+// drivers use, with FreeRTOS on top of std::thread. vfd_host.cpp has the rest.
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#define CLIENT_SERIAL 0
+#define CLIENT_ALL 0xFF
+
+const int SUPPORT_TASK_CORE     = 1;
+const int SPINDLE_AT_SPEED_POLL = 10;  // milliseconds
+
+enum class Error : uint8_t {
+    Ok = 0,
+};
+
+enum class MsgLevel : int8_t {
+    None    = 0,
+    Error   = 1,
+    Warning = 2,
+    Info    = 3,
+    Debug   = 4,
+    Verbose = 5,
+};
+
+enum class SpindleState : uint8_t {
+    Disable = 0,
+    Cw      = 1,
+    Ccw     = 2,
+};
+
+enum class State : uint8_t {
+    Idle = 0,
+    Alarm,
+    CheckMode,
+    Homing,
+    Cycle,
+    Hold,
+    Jog,
+    SafetyDoor,
+    Sleep,
+};
+
+enum class ExecAlarm : uint8_t {
+    None           = 0,
+    SpindleControl = 10,
+};
+
+struct system_t {
+    volatile bool     abort;
+    volatile State    state;
+    volatile uint32_t spindle_speed;
+    uint8_t           spindle_speed_ovr;
+    uint8_t           report_ovr_counter;
+};
+extern system_t           sys;
+extern volatile ExecAlarm sys_rt_exec_alarm;
+
+template <typename T>
+class HostSetting {
+    T _value;
+
+public:
+    HostSetting(T value) : _value(value) {}
+    T    get() { return _value; }
+    void set(T value) { _value = value; }
+};
+
+extern HostSetting<bool>*  laser_mode;
+extern HostSetting<float>* rpm_min;
+extern HostSetting<float>* rpm_max;
+extern HostSetting<float>* spindle_delay_spinup;
+extern HostSetting<float>* spindle_delay_spindown;
+extern HostSetting<float>* spindle_at_speed_tolerance;
+extern HostSetting<float>* spindle_at_speed_timeout;
+
+void        grbl_sendf(uint8_t client, const char* format, ...);
+void        grbl_msg_sendf(uint8_t client, MsgLevel level, const char* format, ...);
+void        report_hex_msg(uint8_t* buf, const char* prefix, int len);
+std::string pinName(uint8_t pin);
+void        mc_reset();
+void        protocol_exec_rt_system();
+void        delay(uint32_t ms);
+int64_t     esp_timer_get_time();
+
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+
+template <typename T>
+T constrain(T value, T low, T high) {
+    return value < low ? low : value > high ? high : value;
+}
+
+// ---- FreeRTOS ----
+
+typedef uint32_t TickType_t;
+typedef int      BaseType_t;
+typedef unsigned UBaseType_t;
+
+const TickType_t portTICK_PERIOD_MS = 1;
+const BaseType_t pdTRUE             = 1;
+const BaseType_t pdFALSE            = 0;
+
+struct HostQueue;
+struct HostTask;
+typedef HostQueue* QueueHandle_t;
+typedef HostTask*  TaskHandle_t;
+
+struct portMUX_TYPE {
+    std::atomic_flag flag;
+};
+#define portMUX_INITIALIZER_UNLOCKED \
+    { ATOMIC_FLAG_INIT }
+
+void portENTER_CRITICAL(portMUX_TYPE* mux);
+void portEXIT_CRITICAL(portMUX_TYPE* mux);
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+BaseType_t    xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks);
+BaseType_t    xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks);
+BaseType_t    xQueueReset(QueueHandle_t queue);
+
+BaseType_t xTaskCreatePinnedToCore(void (*task)(void*),
+                                   const char*   name,
+                                   uint32_t      stack,
+                                   void*         parameters,
+                                   UBaseType_t   priority,
+                                   TaskHandle_t* handle,
+                                   BaseType_t    core);
+uint32_t   ulTaskNotifyTake(BaseType_t clear, TickType_t ticks);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void       vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken);
+void       vTaskDelay(TickType_t ticks);
+
+inline bool xPortInIsrContext() { return false; }
+inline void portYIELD_FROM_ISR() {}
+inline void reportTaskStackSize(UBaseType_t& saved) {}
@@ -0,0 +1,45 @@
+#pragma once
+
+// Stands in for Grbl_Esp32/src/Uart.h on the host. The UART is the process's
+// stdin and stdout, which vfd_sim.py connects to a simulated drive, and
+// flushTxTimed() waits as long as the bytes would take on the line.
+
+#include "Grbl.h"
+
+class Uart {
+private:
+    int     _uart_num;
+    int64_t _tx_done_us;  // when the last byte written would have left the line
+    int     _char_us;
+
+public:
+    enum class Data : int {
+        Bits5 = 0,
+        Bits6 = 1,
+        Bits7 = 2,
+        Bits8 = 3,
+    };
+
+    enum class Stop : int {
+        Bits1   = 1,
+        Bits1_5 = 2,
+        Bits2   = 3,
+    };
+
+    enum class Parity : int {
+        None = 0,
+        Even = 2,
+        Odd  = 3,
+    };
+
+    Uart(int uart_num);
+    bool   setHalfDuplex() { return false; }
+    bool   setPins(int tx_pin, int rx_pin, int rts_pin = -1, int cts_pin = -1) { return false; }
+    void   begin(unsigned long baud, Data dataBits, Stop stopBits, Parity parity, int eventQueueSize = 0);
+    size_t readBytes(char* buffer, size_t length, TickType_t timeout);
+    size_t readBytes(uint8_t* buffer, size_t length, TickType_t timeout) { return readBytes((char*)buffer, length, timeout); }
+    size_t write(const uint8_t* buffer, size_t length);
+    size_t write(const char* buffer, size_t size) { return write((uint8_t*)buffer, size); }
+    void   flush();
+    bool   flushTxTimed(TickType_t ticks);
+};
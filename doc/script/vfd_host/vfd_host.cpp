@@ -0,0 +1,365 @@
+// Runs the RS485 VFD spindle code of the firmware on the host.
+//
+// vfd_sim.py host builds this together with Grbl_Esp32/src/Spindles/VFDSpindle.cpp,
+// Spindle.h and the Huanyang, H2A, YL620 and TecoL510 drivers, unchanged, with
+// Grbl.h and Uart.h from this directory in place of the firmware's. The VFD
+// task talks Modbus on stdin and stdout, where vfd_sim.py answers as the drive,
+// and this program plays the part of the rest of the firmware:
+//
+//   boot, M3 S12000 and the wait for the spindle to reach speed, a burst of
+//   S words sent while moving, then M5, and finally $VFD/Stats
+//
+// Messages and the results go to stderr.
+//
+//   vfd_host <huanyang|h2a|yl620|l510> [burst [interval_ms [tolerance_percent]]]
+
+#include "Spindles/H2ASpindle.h"
+#include "Spindles/HuanyangSpindle.h"
+#include "Spindles/TecoL510.h"
+#include "Spindles/YL620Spindle.h"
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static const Clock::time_point start = Clock::now();
+
+system_t           sys               = { false, State::Idle, 0, 100, 0 };
+volatile ExecAlarm sys_rt_exec_alarm = ExecAlarm::None;
+
+// The defaults of the firmware, except for $30, which matches the simulated drives
+HostSetting<bool>*  laser_mode                 = new HostSetting<bool>(false);
+HostSetting<float>* rpm_min                    = new HostSetting<float>(0);
+HostSetting<float>* rpm_max                    = new HostSetting<float>(24000);
+HostSetting<float>* spindle_delay_spinup       = new HostSetting<float>(0);
+HostSetting<float>* spindle_delay_spindown     = new HostSetting<float>(0);
+HostSetting<float>* spindle_at_speed_tolerance = new HostSetting<float>(2.5);
+HostSetting<float>* spindle_at_speed_timeout   = new HostSetting<float>(10);
+
+Spindles::Spindle* spindle;
+
+int64_t esp_timer_get_time() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+}
+
+void delay(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+static std::mutex report_mutex;
+
+// One write per line, so the lines do not mix with those of vfd_sim.py
+static void vreport(const char* format, va_list args) {
+    char line[256];
+    int  len = snprintf(line, sizeof(line), "%9.3f  ", esp_timer_get_time() / 1e6);
+    vsnprintf(line + len, sizeof(line) - len, format, args);
+    std::lock_guard<std::mutex> lock(report_mutex);
+    fputs(line, stderr);
+}
+
+void grbl_sendf(uint8_t client, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vreport(format, args);
+    va_end(args);
+}
+
+void grbl_msg_sendf(uint8_t client, MsgLevel level, const char* format, ...) {
+    static const char* levels[] = { "", "[MSG:ERR: ", "[MSG:WARN: ", "[MSG:", "[MSG:DBG: ", "[MSG:VRB: " };
+    std::string        message  = std::string(levels[int(level)]) + format + "]\n";
+    va_list            args;
+    va_start(args, format);
+    vreport(message.c_str(), args);
+    va_end(args);
+}
+
+void report_hex_msg(uint8_t* buf, const char* prefix, int len) {
+    std::string message = prefix;
+    char        hex[4];
+    for (int i = 0; i < len; i++) {
+        snprintf(hex, sizeof(hex), " %02X", buf[i]);
+        message += hex;
+    }
+    grbl_msg_sendf(CLIENT_SERIAL, MsgLevel::Info, "%s", message.c_str());
+}
+
+std::string pinName(uint8_t pin) {
+    return "gpio." + std::to_string(pin);
+}
+
+void mc_reset() {
+    sys.abort = true;
+}
+
+void protocol_exec_rt_system() {}
+
+// ---- FreeRTOS on std::thread ----
+
+void portENTER_CRITICAL(portMUX_TYPE* mux) {
+    while (mux->flag.test_and_set(std::memory_order_acquire)) {}
+}
+
+void portEXIT_CRITICAL(portMUX_TYPE* mux) {
+    mux->flag.clear(std::memory_order_release);
+}
+
+static std::chrono::milliseconds ticks_to_ms(TickType_t ticks) {
+    return std::chrono::milliseconds(ticks * portTICK_PERIOD_MS);
+}
+
+struct HostQueue {
+    std::mutex                       mutex;
+    std::condition_variable          changed;
+    std::deque<std::vector<uint8_t>> items;
+    size_t                           length;
+    size_t                           item_size;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    HostQueue* queue = new HostQueue;
+    queue->length    = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void* item, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!queue->changed.wait_for(lock, ticks_to_ms(ticks), [queue] { return queue->items.size() < queue->length; })) {
+        return pdFALSE;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(item);
+    queue->items.emplace_back(bytes, bytes + queue->item_size);
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* item, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(queue->mutex);
+    if (!queue->changed.wait_for(lock, ticks_to_ms(ticks), [queue] { return !queue->items.empty(); })) {
+        return pdFALSE;
+    }
+    memcpy(item, queue->items.front().data(), queue->item_size);
+    queue->items.pop_front();
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    queue->items.clear();
+    queue->changed.notify_all();
+    return pdTRUE;
+}
+
+struct HostTask {
+    std::mutex              mutex;
+    std::condition_variable notified;
+    uint32_t                count = 0;
+};
+
+static thread_local HostTask* current_task = nullptr;
+
+BaseType_t xTaskCreatePinnedToCore(void (*task)(void*),
+                                   const char*   name,
+                                   uint32_t      stack,
+                                   void*         parameters,
+                                   UBaseType_t   priority,
+                                   TaskHandle_t* handle,
+                                   BaseType_t    core) {
+    HostTask* created = new HostTask;
+    if (handle) {
+        *handle = created;
+    }
+    std::thread([=] {
+        current_task = created;
+        task(parameters);
+    }).detach();
+    return pdTRUE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(current_task->mutex);
+    current_task->notified.wait_for(lock, ticks_to_ms(ticks), [] { return current_task->count != 0; });
+    uint32_t count      = current_task->count;
+    current_task->count = clear ? 0 : (count ? count - 1 : 0);
+    return count;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    std::lock_guard<std::mutex> lock(task->mutex);
+    task->count++;
+    task->notified.notify_all();
+    return pdTRUE;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken) {
+    xTaskNotifyGive(task);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    std::this_thread::sleep_for(ticks_to_ms(ticks));
+}
+
+// ---- The UART, on stdin and stdout ----
+
+Uart::Uart(int uart_num) : _uart_num(uart_num), _tx_done_us(0), _char_us(0) {}
+
+void Uart::begin(unsigned long baud, Data dataBits, Stop stopBits, Parity parity, int eventQueueSize) {
+    int bits = 1 + 5 + int(dataBits) + (parity == Parity::None ? 0 : 1) + (stopBits == Stop::Bits1 ? 1 : 2);
+    _char_us = bits * 1000000 / baud;
+}
+
+size_t Uart::write(const uint8_t* buffer, size_t length) {
+    int64_t now = esp_timer_get_time();
+    _tx_done_us = (_tx_done_us > now ? _tx_done_us : now) + int64_t(length) * _char_us;
+    return ::write(STDOUT_FILENO, buffer, length) < 0 ? 0 : length;
+}
+
+bool Uart::flushTxTimed(TickType_t ticks) {
+    int64_t wait_us = _tx_done_us - esp_timer_get_time();
+    if (wait_us > int64_t(ticks) * portTICK_PERIOD_MS * 1000) {
+        return true;
+    }
+    if (wait_us > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(wait_us));
+    }
+    return false;
+}
+
+// Drops whatever is waiting in the receive buffer, like uart_flush()
+void Uart::flush() {
+    struct pollfd fd = { STDIN_FILENO, POLLIN, 0 };
+    char          discard[64];
+    while (poll(&fd, 1, 0) > 0 && ::read(STDIN_FILENO, discard, sizeof(discard)) > 0) {}
+}
+
+// Waits up to timeout for all of length, like uart_read_bytes()
+size_t Uart::readBytes(char* buffer, size_t length, TickType_t timeout) {
+    int64_t deadline = esp_timer_get_time() + int64_t(timeout) * portTICK_PERIOD_MS * 1000;
+    size_t  got      = 0;
+    while (got < length) {
+        int64_t       left = deadline - esp_timer_get_time();
+        struct pollfd fd   = { STDIN_FILENO, POLLIN, 0 };
+        if (left <= 0 || poll(&fd, 1, int((left + 999) / 1000)) <= 0) {
+            break;
+        }
+        ssize_t n = ::read(STDIN_FILENO, buffer + got, length - got);
+        if (n <= 0) {
+            _exit(0);  // vfd_sim.py has gone
+        }
+        got += n;
+    }
+    return got;
+}
+
+// ---- The rest of the Spindle base class ----
+
+namespace Spindles {
+    bool     Spindle::inLaserMode() { return false; }
+    void     Spindle::sync(SpindleState state, uint32_t rpm) { set_state(state, rpm); }
+    void     Spindle::deinit() { stop(); }
+    void     Spindle::activate() { init(); }
+    void     Spindle::deactivate() { deinit(); }
+    uint32_t Spindle::min_rpm() { return rpm_min->get(); }
+    uint32_t Spindle::max_rpm() { return rpm_max->get(); }
+    bool     Spindle::get_actual_rpm(uint32_t& rpm) { return false; }
+
+    // As in Spindle.cpp
+    bool Spindle::wait_for_speed(uint32_t rpm, uint32_t delay_ms) {
+        uint32_t actual;
+        if (!get_actual_rpm(actual)) {
+            delay(delay_ms);
+            return true;
+        }
+
+        uint32_t band = rpm * spindle_at_speed_tolerance->get() / 100.0;
+        if (band < 100) {
+            band = 100;
+        }
+        uint32_t low  = rpm > band ? rpm - band : 0;
+        uint32_t high = rpm + band;
+
+        int64_t  timeout_us = spindle_at_speed_timeout->get() * 1000000.0;
+        int64_t  deadline   = esp_timer_get_time() + timeout_us;
+        uint32_t closest    = UINT32_MAX;
+
+        while (actual < low || actual > high) {
+            uint32_t distance = actual > rpm ? actual - rpm : rpm - actual;
+            if (distance < closest) {
+                closest  = distance;
+                deadline = esp_timer_get_time() + timeout_us;
+            } else if (esp_timer_get_time() > deadline) {
+                grbl_msg_sendf(CLIENT_ALL, MsgLevel::Error, "Spindle did not reach %d rpm. Measured speed is %d rpm.", rpm, actual);
+                mc_reset();
+                sys_rt_exec_alarm = ExecAlarm::SpindleControl;
+                return false;
+            }
+
+            protocol_exec_rt_system();
+            if (sys.abort) {
+                return false;
+            }
+            delay(SPINDLE_AT_SPEED_POLL);
+            get_actual_rpm(actual);
+        }
+        return true;
+    }
+}
+
+// ---- The scenario ----
+
+int main(int argc, char** argv) {
+    std::string drive    = argc > 1 ? argv[1] : "huanyang";
+    int         burst    = argc > 2 ? atoi(argv[2]) : 20;
+    int         interval = argc > 3 ? atoi(argv[3]) : 20;
+    if (argc > 4) {
+        spindle_at_speed_tolerance->set(atof(argv[4]));
+    }
+
+    if (drive == "huanyang") {
+        spindle = new Spindles::Huanyang;
+    } else if (drive == "h2a") {
+        spindle = new Spindles::H2A;
+    } else if (drive == "yl620") {
+        spindle = new Spindles::YL620;
+    } else if (drive == "l510") {
+        spindle = new Spindles::L510;
+    } else {
+        fprintf(stderr, "unknown drive %s\n", drive.c_str());
+        return 1;
+    }
+
+    spindle->init();
+    delay(2000);
+
+    int64_t begin = esp_timer_get_time();
+    spindle->set_state(SpindleState::Cw, 12000);
+    int64_t at_speed = esp_timer_get_time() - begin;
+
+    sys.state = State::Cycle;
+    for (int i = 0; i < burst; i++) {
+        spindle->set_rpm(12000 + (i + 1) * 250);
+        delay(interval);
+    }
+    sys.state = State::Idle;
+    delay(1000);
+
+    begin = esp_timer_get_time();
+    spindle->set_state(SpindleState::Disable, 0);
+    int64_t stopped = esp_timer_get_time() - begin;
+    delay(2000);
+
+    grbl_sendf(CLIENT_SERIAL, "M3 S12000 took %.0f ms, M5 took %.0f ms\n", at_speed / 1000.0, stopped / 1000.0);
+    Spindles::VFD::report_stats(CLIENT_SERIAL);
+    fflush(stderr);
+    _exit(sys.abort ? 2 : 0);
+}
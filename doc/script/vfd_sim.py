@@ -0,0 +1,823 @@
+#!/usr/bin/env python3
+"""\
+Modbus RTU simulator for the RS485 VFD spindles
+
+Simulates the Huanyang, H2A, YL620 and TecoL510 drives, including a spindle
+that ramps to the commanded speed, with a configurable response delay, CRC
+error rate and drop rate.
+
+  bench   a model of the VFD task of Grbl_Esp32/src/Spindles/VFDSpindle.cpp
+          and of the drivers, written in Python, run against the simulated
+          drives in simulated time over a loopback bus that takes as long as
+          the real line at the drive's baud rate. The scenario is boot,
+          M3 S12000, a burst of S words sent while moving (as from the
+          stepper ISR), then M5. It reports the round trip time and retry
+          rate of every transaction, the time to reach speed, and how long
+          the last S word of the burst and the stop took to reach the drive.
+  host    builds the real VFDSpindle.cpp and drivers with the host compiler
+          (g++, or $CXX) against the FreeRTOS and UART shims in vfd_host/,
+          and runs the same scenario in real time, with the simulated drive
+          answering on the program's stdin and stdout. It prints the
+          messages of the task, how long M3 and M5 took, and $VFD/Stats.
+  serve   answers as one drive on a real serial port (needs pyserial), for
+          a USB RS485 adapter wired to a controller. Read the controller's
+          side of the numbers with $VFD/Stats.
+
+The bench does not run the firmware, so keep its model in step with
+VFDSpindle.cpp and the drivers when their timing or messages change, and
+check it against host. Use --poll-rate, --retries, --retry-delay and
+--timeout to try other values of the constants at the top of VFDSpindle.cpp
+in the bench, and --fifo to compare with sending every command in order with
+a poll period after each. host always runs the constants as they are in the
+source.
+
+  vfd_sim.py bench
+  vfd_sim.py bench --drive huanyang --drop 0.05 --crc-error 0.02
+  vfd_sim.py bench --fifo --burst 40
+  vfd_sim.py host --drive h2a --drop 0.05
+  vfd_sim.py serve /dev/ttyUSB0 --drive yl620 --delay 10
+"""
+
+import argparse
+import math
+import os
+import random
+import select
+import shutil
+import struct
+import subprocess
+import tempfile
+import time
+
+CW, CCW, OFF = "Cw", "Ccw", "Off"
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+    return crc
+
+
+def with_crc(body):
+    return bytes(body) + struct.pack("<H", crc16(body))
+
+
+def word(value):
+    return [(value >> 8) & 0xFF, value & 0xFF]
+
+
+def get_word(data, offset):
+    return (data[offset] << 8) | data[offset + 1]
+
+
+class Motor:
+    """A spindle that ramps between 0 and max_rpm in ramp seconds"""
+
+    def __init__(self, max_rpm, ramp):
+        self.rate = max_rpm / ramp
+        self.direction = OFF
+        self.target = 0
+        self.rpm = 0.0
+        self.time = 0.0
+
+    def update(self, now):
+        goal = self.target if self.direction != OFF else 0
+        step = self.rate * (now - self.time)
+        self.time = now
+        if abs(goal - self.rpm) <= step:
+            self.rpm = float(goal)
+        else:
+            self.rpm += step if goal > self.rpm else -step
+
+
+# ---- The drives, as seen from the bus ----------------------------------------
+# respond() gets a request without its CRC and returns the response without
+# its CRC, or None for requests the drive would not answer.
+
+
+class HuanyangDrive:
+    max_rpm = 24000
+    rpm_at_50hz = 3000  # PD144
+    settings = {5: 40000, 11: 12000, 144: rpm_at_50hz}  # PD005, PD011 in 0.01 Hz
+
+    def __init__(self, motor):
+        self.motor = motor
+
+    def hz100(self, rpm):
+        return int(rpm * 5000 / self.rpm_at_50hz)
+
+    def respond(self, req):
+        fn = req[1]
+        if fn == 0x01 and len(req) == 6:  # read setting
+            return req[:4] + word(self.settings.get(req[3], 0))
+        if fn == 0x03 and len(req) == 4:  # control
+            self.motor.direction = {0x01: CW, 0x11: CCW, 0x08: OFF}.get(req[3], self.motor.direction)
+            return req
+        if fn == 0x05 and len(req) == 5:  # set frequency
+            self.motor.target = get_word(req, 3) * self.rpm_at_50hz / 5000
+            return req
+        if fn == 0x04 and len(req) == 6:  # read status
+            values = [self.hz100(self.motor.target), self.hz100(self.motor.rpm), 0, int(self.motor.rpm)]
+            return req[:4] + word(values[req[3]] if req[3] < len(values) else 0)
+        return None
+
+
+class RegisterDrive:
+    """Drives with standard Modbus holding registers (functions 03 and 06)"""
+
+    def __init__(self, motor):
+        self.motor = motor
+
+    def respond(self, req):
+        if req[1] == 0x06 and len(req) == 6:
+            if not self.write(get_word(req, 2), get_word(req, 4)):
+                return None
+            return req
+        if req[1] == 0x03 and len(req) == 6:
+            values = [self.read(get_word(req, 2) + i) for i in range(get_word(req, 4))]
+            if None in values:
+                return None
+            return self.read_response(req, values)
+        return None
+
+    def read_response(self, req, values):
+        return req[:2] + [2 * len(values)] + sum((word(v) for v in values), [])
+
+
+class H2ADrive(RegisterDrive):
+    max_rpm = 24000
+
+    def write(self, reg, value):
+        if reg == 0x2000:
+            self.motor.direction = {1: CW, 2: CCW, 6: OFF}.get(value, self.motor.direction)
+        elif reg == 0x1000:
+            self.motor.target = min(value, 10000) * self.max_rpm / 10000
+        else:
+            return False
+        return True
+
+    def read(self, reg):
+        direction = {CW: 1, CCW: 2, OFF: 3}[self.motor.direction]
+        return {0xB005: self.max_rpm, 0xB006: 400, 0x700C: int(self.motor.rpm), 0x700D: 0, 0x3000: direction}.get(reg)
+
+    def read_response(self, req, values):
+        # The H2A sends the byte count as a word
+        return req[:2] + word(2 * len(values)) + sum((word(v) for v in values), [])
+
+
+class YL620Drive(RegisterDrive):
+    max_rpm = 24000
+    max_freq = 4000  # 0.1 Hz
+
+    def write(self, reg, value):
+        if reg == 0x2000:
+            self.motor.direction = {0x12: CW, 0x22: CCW, 0x01: OFF}.get(value, self.motor.direction)
+        elif reg == 0x2001:
+            self.motor.target = min(value, self.max_freq) * self.max_rpm / self.max_freq
+        else:
+            return False
+        return True
+
+    def read(self, reg):
+        freq = int(self.motor.rpm * self.max_freq / self.max_rpm)
+        status = {CW: 0x12, CCW: 0x22, OFF: 0x01}[self.motor.direction]
+        return {0x0308: 1000, 0x0000: self.max_freq, 0x200B: freq, 0x2000: status}.get(reg)
+
+
+class L510Drive(RegisterDrive):
+    max_rpm = 24000
+    max_freq = 40000  # 0.01 Hz
+
+    def write(self, reg, value):
+        if reg == 0x2501:
+            self.motor.direction = {0: OFF, 1: CW, 3: CCW}.get(value, self.motor.direction)
+        elif reg == 0x2502:
+            self.motor.target = min(value, self.max_freq) * self.max_rpm / self.max_freq
+        else:
+            return False
+        return True
+
+    def read(self, reg):
+        freq = int(self.motor.rpm * self.max_freq / self.max_rpm)
+        state = {CW: 0x01, CCW: 0x03, OFF: 0x00}[self.motor.direction]
+        registers = {0x0203: self.max_rpm, 0x0204: 0, 0x0205: 0, 0x0206: self.max_freq // 10, 0x2520: state, 0x2524: freq}
+        return registers.get(reg)
+
+
+# ---- The drivers, as in Grbl_Esp32/src/Spindles --------------------------------
+# Each message is (request without address and CRC, response length without
+# CRC, parser). Parsers get the response and return False if it is not sane.
+
+
+class Driver:
+    baud = 9600
+    bits = 10  # per character, including start, parity and stop bits
+    safety_polling = True
+
+    def __init__(self):
+        self.min_rpm = 0
+        self.max_rpm = 24000  # $30
+        self.sync_rpm = 0
+
+    def init(self, index):
+        return None
+
+    def rpm_poll(self):
+        return None
+
+    def direction_poll(self):
+        return None
+
+    def status_poll(self):
+        return None
+
+
+class HuanyangDriver(Driver):
+    def __init__(self):
+        super().__init__()
+        self.max_freq = self.min_freq = 0
+        self.rpm_at_50hz = 0
+
+    def direction(self, mode):
+        return [0x03, 0x01, {CW: 0x01, CCW: 0x11, OFF: 0x08}[mode]], 4
+
+    def speed(self, rpm):
+        return [0x05, 0x02] + word(rpm * 5000 // self.rpm_at_50hz if self.rpm_at_50hz else 0), 5
+
+    def init(self, index):
+        register = {-1: 5, -2: 11, -3: 144}.get(index)
+        if register is None:
+            return None
+
+        def parse(resp):
+            value = get_word(resp, 4)
+            if index == -1:
+                self.max_freq = value
+            elif index == -2:
+                self.min_freq = value
+            else:
+                self.rpm_at_50hz = value
+                self.min_rpm = min(self.min_freq, self.max_freq) * value // 5000
+                self.max_rpm = self.max_freq * value // 5000
+            return True
+
+        return [0x01, 0x03, register, 0, 0], 6, parse
+
+    def rpm_poll(self):
+        def parse(resp):
+            self.sync_rpm = get_word(resp, 4) * self.rpm_at_50hz // 5000
+            return True
+
+        return [0x04, 0x03, 0x01, 0, 0], 6, parse
+
+    def status_poll(self):
+        return [0x04, 0x03, 0x00, 0, 0], 6, lambda resp: True
+
+
+class H2ADriver(Driver):
+    baud = 19200
+    bits = 11  # even parity
+    safety_polling = False
+
+    def direction(self, mode):
+        return [0x06, 0x20, 0x00, 0x00, {CW: 0x01, CCW: 0x02, OFF: 0x06}[mode]], 6
+
+    def speed(self, rpm):
+        return [0x06, 0x10, 0x00] + word(min(rpm * 10000 // self.max_rpm, 10000)), 6
+
+    def init(self, index):
+        if index != -1:
+            return None
+
+        def parse(resp):
+            self.max_rpm = get_word(resp, 4)
+            return True
+
+        return [0x03, 0xB0, 0x05, 0x00, 0x02], 8, parse
+
+    def rpm_poll(self):
+        def parse(resp):
+            self.sync_rpm = get_word(resp, 4)
+            return True
+
+        return [0x03, 0x70, 0x0C, 0x00, 0x02], 8, parse
+
+    def direction_poll(self):
+        return [0x03, 0x30, 0x00, 0x00, 0x01], 6, lambda resp: True
+
+
+class YL620Driver(Driver):
+    safety_polling = False
+
+    def __init__(self):
+        super().__init__()
+        self.min_freq = self.max_freq = 0
+
+    def direction(self, mode):
+        return [0x06, 0x20, 0x00, 0x00, {CW: 0x12, CCW: 0x22, OFF: 0x01}[mode]], 6
+
+    def speed(self, rpm):
+        return [0x06, 0x20, 0x01] + word(rpm * self.max_freq // self.max_rpm), 6
+
+    def init(self, index):
+        register = {-1: 0x0308, -2: 0x0000}.get(index)
+        if register is None:
+            return None
+
+        def parse(resp):
+            if index == -1:
+                self.min_freq = get_word(resp, 3)
+            else:
+                self.max_freq = get_word(resp, 3)
+                self.min_rpm = self.min_freq * self.max_rpm // self.max_freq
+            return True
+
+        return [0x03] + word(register) + [0x00, 0x01], 5, parse
+
+    def rpm_poll(self):
+        def parse(resp):
+            self.sync_rpm = get_word(resp, 3) * self.max_rpm // self.max_freq
+            return True
+
+        return [0x03, 0x20, 0x0B, 0x00, 0x01], 5, parse
+
+    def direction_poll(self):
+        return [0x03, 0x20, 0x00, 0x00, 0x01], 5, lambda resp: True
+
+
+class L510Driver(Driver):
+    def __init__(self):
+        super().__init__()
+        self.min_rpm = 6000
+        self.max_freq = 40000
+
+    def direction(self, mode):
+        return [0x06, 0x25, 0x01, 0x00, {OFF: 0x00, CW: 0x01, CCW: 0x03}[mode]], 6
+
+    def speed(self, rpm):
+        return [0x06, 0x25, 0x02] + word(min(rpm * self.max_freq // self.max_rpm, self.max_freq)), 6
+
+    def init(self, index):
+        if index != -1:
+            return None
+
+        def parse(resp):
+            self.max_rpm = get_word(resp, 3)
+            self.max_freq = get_word(resp, 9) * 10
+            return True
+
+        return [0x03, 0x02, 0x03, 0x00, 0x04], 11, parse
+
+    def rpm_poll(self):
+        def parse(resp):
+            self.sync_rpm = get_word(resp, 3) * self.max_rpm // self.max_freq
+            return True
+
+        return [0x03, 0x25, 0x24, 0x00, 0x01], 5, parse
+
+    def direction_poll(self):
+        return [0x03, 0x25, 0x20, 0x00, 0x01], 5, lambda resp: True
+
+    def status_poll(self):
+        return [0x03, 0x25, 0x20, 0x00, 0x01], 5, lambda resp: not get_word(resp, 3) & 0x08
+
+
+DRIVES = {
+    "huanyang": (HuanyangDriver, HuanyangDrive),
+    "h2a": (H2ADriver, H2ADrive),
+    "yl620": (YL620Driver, YL620Drive),
+    "l510": (L510Driver, L510Drive),
+}
+
+
+class Faults:
+    def __init__(self, args, seed):
+        self.delay = args.delay / 1000.0
+        self.jitter = args.jitter / 1000.0
+        self.crc_error = args.crc_error
+        self.drop = args.drop
+        self.random = random.Random(seed)
+
+    def response_delay(self):
+        return self.delay + self.random.uniform(0, self.jitter)
+
+    def apply(self, response):
+        """Returns the response as sent, or None if it is lost"""
+        if self.random.random() < self.drop:
+            return None
+        if self.random.random() < self.crc_error:
+            response = response[:-1] + bytes([response[-1] ^ 0x5A])
+        return response
+
+
+# ---- The bench ---------------------------------------------------------------
+
+
+class Stats:
+    def __init__(self):
+        self.count = self.failures = self.retries = 0
+        self.latencies = []
+
+    def add(self, latency, retries, ok):
+        self.count += 1
+        self.retries += retries
+        self.failures += not ok
+        self.latencies.append(latency)
+
+
+class Bench:
+    """A model of the VFD task and the spindle calls that feed it, in simulated time"""
+
+    ADDRESS = 0x01
+
+    def __init__(self, name, args, seed):
+        driver_class, drive_class = DRIVES[name]
+        self.args = args
+        self.driver = driver_class()
+        self.motor = Motor(drive_class.max_rpm, args.ramp)
+        self.drive = drive_class(self.motor)
+        self.faults = Faults(args, seed)
+        self.char_time = self.driver.bits / self.driver.baud
+        silent_us = 1750 if self.driver.baud > 19200 else 38500000 // self.driver.baud
+        self.silent = (math.ceil(silent_us / 1000) + 1) / 1000.0
+        self.now = 0.0
+        self.mode_queue = []
+        self.speed_slot = None
+        self.speed_superseded = 0
+        self.pollidx = -1
+        self.next_poll = 0.0
+        self.syncing = False
+        self.state = OFF
+        self.stats = {kind: Stats() for kind in ("Mode", "Speed", "Init", "Poll")}
+        self.acked = {}  # tag -> time the drive confirmed the command
+
+    # The spindle side: set_mode and set_rpm
+
+    def set_mode(self, mode, tag=None):
+        body, rx = self.driver.direction(mode)
+        if mode == OFF:
+            self.mode_queue.clear()
+            self.speed_slot = None
+        self.state = mode
+        self.mode_queue.append((body, rx, self.now, tag))
+
+    def set_rpm(self, rpm, tag=None):
+        body, rx = self.driver.speed(rpm)
+        if self.args.fifo:
+            self.mode_queue.append((body, rx, self.now, tag))
+            return
+        if self.speed_slot:
+            self.speed_superseded += 1
+        self.speed_slot = (body, rx, self.now, tag)
+
+    # The task
+
+    def next_message(self):
+        """Returns (kind, body, rx_length, parser, queued, tag), or None if nothing is due"""
+        if self.mode_queue:
+            body, rx, queued, tag = self.mode_queue.pop(0)
+            return "Mode", body, rx, None, queued, tag
+        if self.speed_slot:
+            body, rx, queued, tag = self.speed_slot
+            self.speed_slot = None
+            return "Speed", body, rx, None, queued, tag
+        if self.now < self.next_poll:
+            return None
+        if self.syncing:
+            self.next_poll = self.now
+        elif self.state == OFF and self.pollidx > 0 and not self.args.fifo:
+            self.next_poll = self.now + self.args.idle_poll / 1000.0
+        else:
+            self.next_poll = self.now + self.args.poll_rate / 1000.0
+
+        if self.pollidx < 0 or self.driver.max_rpm == 0:
+            message = self.driver.init(self.pollidx)
+            if message:
+                return ("Init",) + message + (self.now, None)
+        if self.pollidx < 0:
+            self.pollidx = 1
+        message = None
+        if self.syncing:
+            message = self.driver.rpm_poll()
+        elif self.driver.safety_polling:
+            for index, poll in ((1, self.driver.rpm_poll), (2, self.driver.direction_poll), (3, self.driver.status_poll)):
+                if index >= self.pollidx or index == 3:
+                    message = poll()
+                    if message or index == 3:
+                        self.pollidx = index + 1 if index < 3 else 1
+                        break
+        if message is None:
+            return None
+        return ("Poll",) + message + (self.now, None)
+
+    def transaction(self, body, rx_length):
+        """Sends one request and returns the response, or None. Advances the clock."""
+        request = with_crc([self.ADDRESS] + body)
+        self.now += len(request) * self.char_time
+        response = self.drive.respond(list(request[:-2]))
+        if response is None:
+            self.now += self.args.timeout / 1000.0
+            return None
+        self.now += self.faults.response_delay()
+        self.motor.update(self.now)
+        sent = self.faults.apply(with_crc(response))
+        if sent is None:
+            self.now += self.args.timeout / 1000.0
+            return None
+        self.now += len(sent) * self.char_time
+        if len(sent) != rx_length + 2 or sent[0] != self.ADDRESS or crc16(sent[:-2]) != struct.unpack("<H", sent[-2:])[0]:
+            return None
+        return sent
+
+    def step(self):
+        """Runs one pass of the task loop"""
+        message = self.next_message()
+        if message is None:
+            self.now = self.next_poll if self.next_poll > self.now else self.now + self.silent
+            return
+        kind, body, rx_length, parser, queued, tag = message
+        ok = False
+        attempts = 0
+        while attempts < self.args.retries and not ok:
+            attempts += 1
+            response = self.transaction(body, rx_length)
+            if response is None:
+                self.now += self.args.retry_delay / 1000.0
+                continue
+            ok = True
+            if parser and parser(list(response)):
+                if self.pollidx < 0:
+                    self.pollidx -= 1
+            elif parser:
+                self.pollidx = -1
+        if not ok:
+            self.pollidx = -1
+        self.stats[kind].add(self.now - queued, attempts - 1, ok)
+        if ok and tag:
+            self.acked[tag] = self.now
+        self.now += self.args.poll_rate / 1000.0 if self.args.fifo else self.silent
+
+    def run_until(self, end, until=None):
+        while self.now < end and not (until and until()):
+            self.motor.update(self.now)
+            self.step()
+
+    def at_speed(self, rpm):
+        band = max(int(rpm * self.args.tolerance / 100), 100)  # as in Spindle::wait_for_speed
+        return abs(self.driver.sync_rpm - rpm) <= band
+
+    def scenario(self):
+        """Returns the measured times in ms"""
+        args = self.args
+        results = {}
+        self.run_until(2.0, lambda: self.pollidx > 0)
+        results["init"] = self.now * 1000
+        self.run_until(2.0)
+
+        # M3 S12000, then the wait in VFD::set_state
+        start = self.now
+        self.set_mode(CW)
+        self.set_rpm(12000)
+        self.syncing = True
+        self.run_until(start + 20.0, lambda: self.at_speed(12000))
+        results["to_speed"] = (self.now - start) * 1000
+        self.syncing = False
+
+        # S words while moving, every --burst-interval ms
+        start = self.now
+        rpm = 12000
+        for i in range(args.burst):
+            rpm = 12000 + (i + 1) * 250
+            self.set_rpm(rpm, tag="S%d" % i)
+            self.run_until(start + (i + 1) * args.burst_interval / 1000.0)
+        last = "S%d" % (args.burst - 1)
+        last_queued = start + (args.burst - 1) * args.burst_interval / 1000.0
+        self.run_until(self.now + 20.0, lambda: last in self.acked)
+        results["last_s"] = (self.acked[last] - last_queued) * 1000 if last in self.acked else float("nan")
+
+        # M5
+        self.run_until(self.now + 1.0)
+        start = self.now
+        self.set_mode(OFF, tag="M5")
+        self.set_rpm(0)
+        self.run_until(start + 20.0, lambda: "M5" in self.acked)
+        results["stop"] = (self.acked["M5"] - start) * 1000 if "M5" in self.acked else float("nan")
+        self.run_until(self.now + 2.0)
+        return results
+
+
+def bench(args):
+    names = list(DRIVES) if args.drive == "all" else [args.drive]
+    print("%-9s %8s %9s %8s %8s %7s %5s %8s %6s %8s" %
+          ("drive", "init", "at speed", "rtt avg", "rtt max", "retry", "fail", "last S", "dropS", "stop"))
+    for name in names:
+        totals = Stats()
+        results = {key: [] for key in ("init", "to_speed", "last_s", "stop")}
+        superseded = 0
+        for run in range(args.runs):
+            b = Bench(name, args, seed=run)
+            for key, value in b.scenario().items():
+                results[key].append(value)
+            for kind in ("Init", "Poll"):
+                s = b.stats[kind]
+                totals.count += s.count
+                totals.retries += s.retries
+                totals.failures += s.failures
+                totals.latencies += s.latencies
+            superseded += b.speed_superseded
+
+        def mean(values):
+            return sum(values) / len(values) if values else float("nan")
+
+        print("%-9s %6.0fms %7.0fms %6.1fms %6.1fms %6.1f%% %5d %6.1fms %6.1f %6.1fms" % (
+            name,
+            mean(results["init"]),
+            mean(results["to_speed"]),
+            mean(totals.latencies) * 1000,
+            max(totals.latencies or [0]) * 1000,
+            100.0 * totals.retries / max(totals.count, 1),
+            totals.failures,
+            mean(results["last_s"]),
+            superseded / args.runs,
+            mean(results["stop"])))
+    print("rtt and retry are over polls, which are not delayed by other traffic; "
+          "times are averages over %d runs" % args.runs)
+
+
+# ---- Serving a bus -------------------------------------------------------------
+
+
+def answer(port, args, name, seed=None):
+    """Answers requests on port as the drive until the port is closed"""
+    driver_class, drive_class = DRIVES[name]
+    char_time = driver_class.bits / port.baudrate
+    motor = Motor(drive_class.max_rpm, args.ramp)
+    drive = drive_class(motor)
+    faults = Faults(args, seed)
+    start = time.monotonic()
+    counts = {"frames": 0, "answered": 0, "bad": 0, "other": 0}
+    last_rpm = None
+    try:
+        while True:
+            port.timeout = None
+            frame = port.read(1)
+            if not frame:
+                break
+            port.timeout = max(3.5 * char_time, 0.002)
+            while True:
+                more = port.read(64)
+                if not more:
+                    break
+                frame += more
+            counts["frames"] += 1
+            if len(frame) < 4 or crc16(frame[:-2]) != struct.unpack("<H", frame[-2:])[0]:
+                counts["bad"] += 1
+                continue
+            if frame[0] != Bench.ADDRESS:
+                counts["other"] += 1
+                continue
+            motor.update(time.monotonic() - start)
+            response = drive.respond(list(frame[:-2]))
+            if response is None:
+                continue
+            time.sleep(faults.response_delay())
+            sent = faults.apply(with_crc(response))
+            if sent is not None:
+                port.write(sent)
+                counts["answered"] += 1
+            if int(motor.target) != last_rpm:
+                last_rpm = int(motor.target)
+                print("%9.3f  drive: %s %d rpm" % (time.monotonic() - start, motor.direction, last_rpm), flush=True)
+    except KeyboardInterrupt:
+        pass
+    print("drive: " + ", ".join("%s %d" % item for item in counts.items()), flush=True)
+
+
+def serve(args):
+    import serial
+
+    driver_class = DRIVES[args.drive][0]
+    parity = serial.PARITY_EVEN if driver_class.bits == 11 else serial.PARITY_NONE
+    port = serial.Serial(args.port, args.baud or driver_class.baud, parity=parity, timeout=None)
+    print("simulating %s on %s at %d baud; ^C to stop" % (args.drive, args.port, port.baudrate))
+    answer(port, args, args.drive)
+
+
+# ---- The firmware's VFD task on the host ---------------------------------------
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+SPINDLES = os.path.join(HERE, "..", "..", "Grbl_Esp32", "src", "Spindles")
+HOST_SOURCES = ["VFDSpindle", "HuanyangSpindle", "H2ASpindle", "YL620Spindle", "TecoL510"]
+
+
+def build_host(workdir):
+    """Builds vfd_host/vfd_host.cpp with the firmware's VFD spindles, and returns the program"""
+    src = os.path.join(workdir, "src")
+    os.makedirs(os.path.join(src, "Spindles"))
+    for header in ("driver/dac.h", "driver/uart.h", "freertos/task.h"):  # ESP-IDF headers the shim replaces
+        path = os.path.join(workdir, "include", header)
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        open(path, "w").close()
+    for shim in ("Grbl.h", "Uart.h"):
+        shutil.copy(os.path.join(HERE, "vfd_host", shim), src)
+    sources = [os.path.join(HERE, "vfd_host", "vfd_host.cpp")]
+    shutil.copy(os.path.join(SPINDLES, "Spindle.h"), os.path.join(src, "Spindles"))
+    for name in HOST_SOURCES:
+        for ext in (".h", ".cpp"):
+            shutil.copy(os.path.join(SPINDLES, name + ext), os.path.join(src, "Spindles"))
+        sources.append(os.path.join(src, "Spindles", name + ".cpp"))
+    program = os.path.join(workdir, "vfd_host")
+    subprocess.check_call([os.environ.get("CXX", "g++"), "-std=c++17", "-O1", "-pthread",
+                           "-I" + os.path.join(workdir, "include"), "-I" + src,
+                           "-DVFD_RS485_TXD_PIN=17", "-DVFD_RS485_RXD_PIN=4", "-DVFD_RS485_RTS_PIN=16"] +
+                          sources + ["-o", program])
+    return program
+
+
+class PipePort:
+    """The controller's end of the bus, on the pipes of the host program
+
+    Bytes take as long as they would on the line at the drive's baud rate, in
+    both directions, so the timing matches a real bus.
+    """
+
+    def __init__(self, process, driver_class):
+        self.process = process
+        self.baudrate = driver_class.baud
+        self.char_time = driver_class.bits / self.baudrate
+        self.timeout = None
+        self.line_free = 0.0
+
+    def occupy_line(self, count):
+        self.line_free = max(self.line_free, time.monotonic()) + count * self.char_time
+        time.sleep(max(self.line_free - time.monotonic(), 0))
+
+    def read(self, size):
+        ready = select.select([self.process.stdout], [], [], self.timeout)[0]
+        if not ready:
+            return b""
+        data = os.read(self.process.stdout.fileno(), size)
+        self.occupy_line(len(data))
+        return data
+
+    def write(self, data):
+        self.occupy_line(len(data))
+        try:
+            self.process.stdin.write(data)
+            self.process.stdin.flush()
+        except BrokenPipeError:
+            pass
+
+
+def host(args):
+    names = list(DRIVES) if args.drive == "all" else [args.drive]
+    with tempfile.TemporaryDirectory() as workdir:
+        program = build_host(workdir)
+        for name in names:
+            print("---- %s, running Spindles/VFDSpindle.cpp and its driver in real time" % name, flush=True)
+            process = subprocess.Popen([program, name, str(args.burst), str(int(args.burst_interval)), str(args.tolerance)],
+                                       stdin=subprocess.PIPE, stdout=subprocess.PIPE, bufsize=0)
+            answer(PipePort(process, DRIVES[name][0]), args, name)
+            process.wait()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("mode", choices=("bench", "host", "serve"))
+    parser.add_argument("port", nargs="?", help="serial port, for serve")
+    parser.add_argument("--drive", default="all", choices=["all"] + list(DRIVES))
+    parser.add_argument("--delay", type=float, default=5.0, help="drive response delay in ms")
+    parser.add_argument("--jitter", type=float, default=2.0, help="random extra delay, up to this many ms")
+    parser.add_argument("--crc-error", type=float, default=0.0, help="fraction of responses with a bad CRC")
+    parser.add_argument("--drop", type=float, default=0.0, help="fraction of responses that are lost")
+    parser.add_argument("--ramp", type=float, default=4.0, help="seconds from 0 to max rpm")
+    parser.add_argument("--baud", type=int, help="for serve; defaults to the driver's rate")
+    group = parser.add_argument_group("bench", "the constants of VFDSpindle.cpp, and the scenario; host takes only "
+                                      "--tolerance, --burst and --burst-interval")
+    group.add_argument("--poll-rate", type=float, default=250, help="VFD_RS485_POLL_RATE in ms")
+    group.add_argument("--idle-poll", type=float, default=1000, help="VFD_RS485_IDLE_POLL in ms")
+    group.add_argument("--retries", type=int, default=5, help="MAX_RETRIES")
+    group.add_argument("--retry-delay", type=float, default=250, help="delay before a retry in ms")
+    group.add_argument("--timeout", type=float, default=1000, help="RESPONSE_WAIT_MILLIS")
+    group.add_argument("--tolerance", type=float, default=2.5, help="$Spindle/AtSpeed/Tolerance in percent")
+    group.add_argument("--fifo", action="store_true", help="queue every command, and wait a poll period after each")
+    group.add_argument("--burst", type=int, default=20, help="number of S words sent while moving")
+    group.add_argument("--burst-interval", type=float, default=20, help="ms between those S words")
+    group.add_argument("--runs", type=int, default=20)
+    args = parser.parse_args()
+
+    if args.mode == "serve":
+        if not args.port or args.drive == "all":
+            parser.error("serve needs a port and a --drive")
+        serve(args)
+    elif args.mode == "host":
+        host(args)
+    else:
+        bench(args)
+
+
+if __name__ == "__main__":
+    main()